@@ -13,12 +13,14 @@ inherit "/lib/commands";
 inherit "/std/callout";
 
 #include <files.h>
+#include <macros.h>
 #include <std.h>
 
 /*
  * Prototype.
  */
 public mapping query_cmdlist();
+static int changed_commands();
 
 /*
  * Global variable.
@@ -26,6 +28,7 @@ public mapping query_cmdlist();
  * cmdlist   - the list of verbs and functions.
  */
 static mapping cmdlist = query_cmdlist();
+static int     cmdlist_loaded = changed_commands();
 
 /*
  * Function name: query_cmdlist
@@ -50,6 +53,26 @@ public void
 update_commands()
 {
     cmdlist = query_cmdlist();
+    changed_commands();
+}
+
+/*
+ * Function name: changed_commands
+ * Description  : Tell the index of the souls that our commands may have
+ *                changed, so the livings look at them again. This is done
+ *                when the soul is loaded and when the commands are updated.
+ *                Clones, like spell objects, are not souls.
+ * Returns      : int 1 - always.
+ */
+static int
+changed_commands()
+{
+    if (!IS_CLONE)
+    {
+        SOUL_INDEX->bump_generation();
+    }
+
+    return 1;
 }
 
 /* 
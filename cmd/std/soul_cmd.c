@@ -391,60 +391,7 @@ dump_emotions()
 object *
 find_neighbour(object *found, object *search, int depth)
 {
-    int index;
-    int size;
-    int index2;
-    int size2;
-    mixed *exit_arr;
-    object *new_search, *rooms, troom, *doors;
-
-    if (!depth)
-    {
-        return found;
-    }
-
-    rooms = found;
-    new_search = ({ });
-
-    index = -1;
-    size = sizeof(search);
-    while(++index < size)
-    {
-        exit_arr = (mixed *)search[index]->query_exit();
-
-        index2 = -3;
-        size2 = sizeof(exit_arr);
-        while((index2 += 3) < size2)
-        {
-            if (functionp(exit_arr[index2]))
-                continue;
-            if (objectp(exit_arr[index2]))
-                troom = exit_arr[index2];
-            else
-                troom = find_object(exit_arr[index2]);
-            if (objectp(troom) &&
-                (member_array(troom, rooms) < 0))
-            {
-                rooms += ({ troom });
-                new_search += ({ troom });
-            }
-        }
-
-        doors = search[index]->query_prop(ROOM_AO_DOOROB);
-
-        index2 = -1;
-        size2 = sizeof(doors);
-        while (++index2 < size2)
-        {
-            if (objectp(troom = find_object(doors[index2]->query_other_room())) &&
-                member_array(troom, rooms) < 0)
-            {
-                rooms += ({ troom });
-            }
-        }
-    }
-
-    return find_neighbour(rooms, new_search, depth - 1);
+    return CMDPARSE_STD->recurse_neighbours(found, search, depth);
 }
 
 /* **************************************************************************
@@ -1361,6 +1361,7 @@ last_check(string who, int login)
 {
     string result;
     object pl;
+    mixed  entry;
     int    tmp;
     int    t_in;
     int    t_out;
@@ -1388,20 +1389,17 @@ last_check(string who, int login)
     }
     else
     {
-        /* Get a finger-player to get the login time, then clean out the
-         * finger-player again. We do not want to waste the memory.
-         */
-        pl = SECURITY->finger_player(who[1..]);
-        if (!pl)
+        /* Get the login time from the player index. */
+        entry = SECURITY->query_player_index(who[1..]);
+        if (!pointerp(entry))
         {
             if (who[0..0] == "<")
                 return sprintf("%-14s No such player", capitalize(who[1..]));
             else
                 return sprintf("  %-12s No such player", capitalize(who[1..]));
         }
-        t_in = pl->query_login_time();
-        t_out = pl->query_logout_time();
-        pl->remove_object();
+        t_in = entry[PIDX_LOGIN];
+        t_out = entry[PIDX_LOGOUT];
 
         /* This test checks whether the alleged duration of the last
          * visit of the wizard does not exceed two days. If the wizard
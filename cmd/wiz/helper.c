@@ -180,7 +180,7 @@ badname_sort_set(string name1, string name2)
 public nomask int
 badname(string str)
 {
-    mixed info;
+    mixed info, entry;
     string *names;
     object player;
     string text, name, age;
@@ -218,12 +218,11 @@ badname(string str)
                 text = interactive(find_player(name)) ? "Logged on " : "Linkdead  ";
 		age = TIME2STR(player->query_age() * F_SECONDS_PER_BEAT, 2);
             }
-            else if (objectp(player = SECURITY->finger_player(name)))
+            else if (pointerp(entry = SECURITY->query_player_index(name)))
             {
-                badnames_login[name] = player->query_login_time();
+                badnames_login[name] = entry[PIDX_LOGIN];
                 text = TIME2FORMAT(badnames_login[name], "d mmm yyyy");
-		age = TIME2STR(player->query_age() * F_SECONDS_PER_BEAT, 2);
-                player->remove_object();
+		age = TIME2STR(entry[PIDX_AGE] * F_SECONDS_PER_BEAT, 2);
             }
             else
             {
@@ -302,9 +301,8 @@ badname(string str)
         write("The name " + capitalize(name) + " is already marked as inappropriate.\n");
         return 1;
     }
-    player = SECURITY->finger_player(name);
-    tme = player->query_age() * F_SECONDS_PER_BEAT;
-    player->remove_object();
+    entry = SECURITY->query_player_index(name);
+    tme = (pointerp(entry) ? entry[PIDX_AGE] : 0) * F_SECONDS_PER_BEAT;
     if (tme > 86400)
     {
 	write("Player " + capitalize(name) + " is already " + CONVTIME(tme) +
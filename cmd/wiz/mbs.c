@@ -49,6 +49,7 @@ int		GcCheck;		// Last time GC was checked.
 static string	*ErrArgs;		// Error arguments
 static string	*NoNews;		// No news messages 
 static int	NoNewsNum;		// The number of messages
+static mapping	UnreadMap;		// Boards with unread news
 /*
  * Some prototypes.
  */
@@ -722,6 +723,14 @@ list_subscribed(int unread, int all)
 	header += sprintf("%-11s", "---------");
     header += sprintf("%-31s%s\n", "-----------", "------");
 
+    /*
+     * Get the unread status of all subscribed boards from the central
+     * in one call, rather than asking about each board in turn.
+     */
+    if (unread)
+	UnreadMap = MC->query_unread_boards(mkmapping(m_indexes(BdMap),
+	    map(m_values(BdMap), &operator([])(, SB_LNOTE))));
+
     /*
      * First check if unread listing, then report other unread
      * selections as well.
@@ -817,6 +826,8 @@ list_subscribed(int unread, int all)
 	if (first && !news)
 	    write(NO_NEWS);
     }
+
+    UnreadMap = 0;
 }
 
 /*
@@ -2395,6 +2406,9 @@ shuffle_boards()
 static nomask int
 filt_unread_news(mixed list)
 {
+    if (mappingp(UnreadMap))
+	return UnreadMap[list[SB_SPATH]];
+
     return (MC->query_unread_news(list[SB_SPATH], list[SB_LNOTE]));
 }
 
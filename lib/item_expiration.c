@@ -31,7 +31,7 @@
 
 // Global Variables
 static int      gExpiration = 0,    // The timestamp for when the item expires
-                gExpireAlarm = 0,   // The alarm for breaking items
+                gExpireAlarm = 0,   // The timer for breaking items
                 gUptimeLimit = 0;   // The timestamp of the next armageddon
 
 /*
@@ -103,7 +103,8 @@ update_item_expiration_alarm()
     float expire = 0.0;
     
     if (gExpireAlarm)
-        remove_alarm(gExpireAlarm);
+        TIMER_WHEEL->remove_timer(gExpireAlarm);
+    gExpireAlarm = 0;
     
     if (gExpiration > time())
     {
@@ -117,7 +118,8 @@ update_item_expiration_alarm()
         expire = itof(gExpiration - time());
     }
     
-    gExpireAlarm = set_alarm(expire, 0.0, &item_expiration_break());
+    /* Items expire after days, so use the shared timer wheel. */
+    gExpireAlarm = TIMER_WHEEL->add_timer(expire, &item_expiration_break());
 } /* update_item_expiration_alarm */
 
 /*
@@ -159,7 +161,8 @@ remove_item_expiration()
     gExpiration = 0;
     
     if (gExpireAlarm)
-        remove_alarm(gExpireAlarm);
+        TIMER_WHEEL->remove_timer(gExpireAlarm);
+    gExpireAlarm = 0;
 } /* remove_item_expiration */
 
 /*
@@ -41,6 +41,11 @@
  *       function properly.  If a shelf is added, a directory with the
  *       same name as the shelf must exist under the the directory given
  *       to set_book_directory().
+ *
+ *       The title, summary and author of all books are kept in an index
+ *       file in the book directory, so that the books themselves only need
+ *       to be read when they have changed. Files starting with a period
+ *       are never taken to be books.
  */
 
 #include <cmdparse.h>
@@ -69,6 +74,15 @@
 
 #define MAX_TITLE_SIZE 20
 
+#define INDEX_FILE   ".index"
+
+/* Indices in the book header index */
+#define HDR_TIME     0
+#define HDR_SIZE     1
+#define HDR_TITLE    2
+#define HDR_SUMMARY  3
+#define HDR_AUTHOR   4
+
 static int borrow_required;
 
 static string  book_dir  = "",
@@ -88,6 +102,8 @@ static string  book_dir  = "",
 static mapping book_map;
 static mapping appr_map;
 static mapping book_shelves = ([]);
+static mapping book_headers;
+static int     headers_changed;
 
 public void done_writing(string title, string summary, string input);
 public int library_approve_access();
@@ -779,16 +795,14 @@ library_move_book(string book_file, string new_dir)
 }
 
 /*
- * Function name: query_book_title
- * Description:   Given a book file, return the book's title
- * Arguments:     string file - The filename for the desired book
- * Returns:       The book's title
+ * Function name: clean_header_line
+ * Description:   Strip the padding from a header line of a book file.
+ * Arguments:     string str - the line
+ * Returns:       The cleaned line
  */
-public string
-query_book_title(string file)
+static string
+clean_header_line(string str)
 {
-    string str = read_file(file, TITLE_LINE, 1);
-
     /* remove trailing "\n" */
     if (strlen(str) && (str[-1..] == "\n"))
     {
@@ -799,6 +813,64 @@ query_book_title(string file)
     return implode(explode(str, " ") - ({ "" }), " ");
 }
 
+/*
+ * Function name: query_book_header
+ * Description:   Get the header of a book file from the index. The header
+ *                lines are only read from the file itself when the file
+ *                changed since it was indexed.
+ * Arguments:     string file - the filename for the desired book
+ * Returns:       ({ file time, file size, title, summary, author })
+ */
+public mixed
+query_book_header(string file)
+{
+    mixed hdr;
+    string str, *lines;
+    int tm, sz;
+
+    if (!mappingp(book_headers))
+    {
+        book_headers = ([]);
+    }
+
+    setuid();
+    seteuid(getuid());
+
+    tm = file_time(file);
+    sz = file_size(file);
+    hdr = book_headers[file];
+    if (pointerp(hdr) && (hdr[HDR_TIME] == tm) && (hdr[HDR_SIZE] == sz))
+    {
+        return hdr;
+    }
+
+    /* Read all header lines in one go. */
+    lines = ({ "", "", "" });
+    if (strlen(str = read_file(file, TITLE_LINE, 3)))
+    {
+        lines = explode(str, "\n") + lines;
+    }
+    hdr = ({ tm, sz, clean_header_line(lines[TITLE_LINE - 1]),
+        clean_header_line(lines[SUMMARY_LINE - 1]),
+        clean_header_line(lines[AUTHOR_LINE - 1]) });
+    book_headers[file] = hdr;
+    headers_changed = 1;
+
+    return hdr;
+}
+
+/*
+ * Function name: query_book_title
+ * Description:   Given a book file, return the book's title
+ * Arguments:     string file - The filename for the desired book
+ * Returns:       The book's title
+ */
+public string
+query_book_title(string file)
+{
+    return query_book_header(file)[HDR_TITLE];
+}
+
 /*
  * Function name: query_book_author
  * Description:   Given a book file, return the book's author
@@ -808,16 +880,7 @@ query_book_title(string file)
 public string
 query_book_author(string file)
 {
-    string str = read_file(file, AUTHOR_LINE, 1);
-
-    /* remove trailing "\n" */
-    if (strlen(str) && (str[-1..] == "\n"))
-    {
-        str = str[..-2];
-    }
-
-    /* remove extra whitespace and return */
-    return implode(explode(str, " ") - ({ "" }), " ");
+    return query_book_header(file)[HDR_AUTHOR];
 }
 
 /*
@@ -829,16 +892,7 @@ query_book_author(string file)
 public string
 query_book_summary(string file)
 {
-    string str = read_file(file, SUMMARY_LINE, 1);
-
-    /* remove trailing "\n" */
-    if (strlen(str) && (str[-1..] == "\n"))
-    {
-        str = str[..-2];
-    }
-
-    /* remove extra whitespace and return */
-    return implode(explode(str, " ") - ({ "" }), " ");
+    return query_book_header(file)[HDR_SUMMARY];
 }
 
 /*
@@ -867,7 +921,8 @@ get_books(string dir)
     setuid();
     seteuid(getuid());
 
-    books = map(get_dir(dir), &operator(+)(dir));
+    books = filter(get_dir(dir), &operator(!=)('.') @ &operator([])(, 0));
+    books = map(books, &operator(+)(dir));
 
     /* Any non-empty file is counted as a book */
     books = filter(books, &operator(>)(,0) @ file_size);
@@ -944,20 +999,96 @@ format_book_list_short(string *books)
     return sprintf("%-#70.2s\n", implode(titles, "\n"));
 }
 
+/*
+ * Function name: query_index_file
+ * Description:   Find the file the book header index is saved in.
+ * Returns:       The filename, without the .o, or 0 if there is none.
+ */
+public string
+query_index_file()
+{
+    if (strlen(book_dir))
+    {
+        return book_dir + INDEX_FILE;
+    }
+
+    if (strlen(appr_dir))
+    {
+        return appr_dir + INDEX_FILE;
+    }
+
+    return 0;
+}
+
+/*
+ * Function name: restore_book_index
+ * Description:   Read the book header index from disk.
+ */
+static void
+restore_book_index()
+{
+    string file = query_index_file();
+
+    book_headers = ([]);
+    if (strlen(file) && (file_size(file + ".o") > 0))
+    {
+        catch(book_headers = restore_map(file));
+        if (!mappingp(book_headers))
+        {
+            book_headers = ([]);
+        }
+    }
+    headers_changed = 0;
+}
+
+/*
+ * Function name: save_book_index
+ * Description:   Drop the books that are no longer in the library from the
+ *                book header index and write it to disk if it changed.
+ * Arguments:     string *books - all books in the library
+ */
+static void
+save_book_index(string *books)
+{
+    string file = query_index_file();
+    int size = m_sizeof(book_headers);
+
+    book_headers = mkmapping(books,
+        map(books, &operator([])(book_headers, )));
+    book_headers = filter(book_headers, pointerp);
+
+    if (!headers_changed && (m_sizeof(book_headers) == size))
+    {
+        return;
+    }
+
+    headers_changed = 0;
+    if (strlen(file))
+    {
+        save_map(book_headers, file);
+    }
+}
+
 /*
  * Function name: update_books
  * Description:   Update the in-memory book information when something
- *                has changed.
+ *                has changed. Only books that changed since they were
+ *                last indexed are read.
  */
 public void
 update_books()
 {
-    string *books, *shelves, shelf_list, shelf_list_short;
+    string *books, *shelves, *all_books = ({ }), shelf_list, shelf_list_short;
     int i;
 
     setuid();
     seteuid(getuid());
 
+    if (!mappingp(book_headers))
+    {
+        restore_book_index();
+    }
+
     book_map = ([]);
     appr_map = ([]);
     book_list = "";
@@ -978,6 +1109,7 @@ update_books()
                 book_list_short += shelf_list_short;
                 book_shelves[shelves[i]] = ({ shelf_list, shelf_list_short });
                 get_book_info(books, book_map);
+                all_books += books;
             }
         }
         else
@@ -986,6 +1118,7 @@ update_books()
             book_list = format_book_list(books);
             book_list_short = format_book_list_short(books);
             get_book_info(books, book_map);
+            all_books += books;
         }
     }
 
@@ -995,7 +1128,10 @@ update_books()
         appr_list = format_book_list(books);
         appr_list_short = format_book_list_short(books);
         get_book_info(books, appr_map);
+        all_books += books;
     }
+
+    save_book_index(all_books);
 }
 
 /*
@@ -0,0 +1,175 @@
+/*
+ * /obj/cooldown_bench.c
+ *
+ * A small gadget for wizards to time the cooldowns in livings. It clones a
+ * number of monsters, triggers thousands of cooldowns spread over them and
+ * queries them all a few times, then removes the monsters again.
+ *
+ *     cdbench [<livings> [<cooldowns per living>]]
+ */
+
+#pragma no_inherit
+#pragma save_binary
+#pragma strict_types
+
+inherit "/std/object";
+
+#include <files.h>
+
+#define BENCH_LIVINGS   (20)  /* The default number of livings.           */
+#define BENCH_COOLDOWNS (100) /* The default number of cooldowns each.    */
+#define BENCH_QUERIES   (4)   /* How often each cooldown is queried.      */
+#define BENCH_EXPIRED   (10)  /* Every so many cooldowns expire at once.  */
+#define BENCH_KEY       ("_cooldown_bench_")
+
+/*
+ * Prototypes
+ */
+public int cdbench(string str);
+
+/*
+ * Function name: create_object
+ * Description  : This function is called when the object is created.
+ */
+public void
+create_object()
+{
+    set_name("stopwatch");
+    add_name("bench");
+    add_adj("brass");
+
+    set_short("brass stopwatch");
+    set_long("It is a brass stopwatch for timing cooldowns. Linked " +
+        "command:\n" +
+        "    cdbench [<livings> [<cooldowns per living>]]\n" +
+        "The defaults are " + BENCH_LIVINGS + " livings with " +
+        BENCH_COOLDOWNS + " cooldowns each.\n");
+}
+
+/*
+ * Function name: init
+ * Description  : This function is called to link the command of this
+ *                stopwatch to the wizard using it.
+ */
+void
+init()
+{
+    ::init();
+
+    if ((environment(this_object()) == this_player()) &&
+        this_player()->query_wiz_level())
+    {
+        add_action(cdbench, "cdbench");
+    }
+}
+
+/*
+ * Function name: cdbench
+ * Description  : Time the triggering, refreshing and querying of cooldowns
+ *                over a number of livings. Every BENCH_EXPIRED-th cooldown
+ *                is triggered with no duration, so it expires on the first
+ *                query. The results of the queries are checked too.
+ * Arguments    : string str - the command line argument.
+ * Returns      : int 1/0 - success/failure.
+ */
+public int
+cdbench(string str)
+{
+    object *livings;
+    int    count = BENCH_LIVINGS;
+    int    each = BENCH_COOLDOWNS;
+    int    index, key, round, total, refreshed, mismatches;
+    float  start, trigger_time, refresh_time, query_time;
+
+    if (strlen(str) &&
+        (sscanf(str, "%d %d", count, each) != 2) &&
+        (sscanf(str, "%d", count) != 1))
+    {
+        notify_fail("Syntax: cdbench [<livings> [<cooldowns per living>]]\n");
+        return 0;
+    }
+
+    if ((count < 1) || (each < 1))
+    {
+        notify_fail("There must be at least one living and one cooldown.\n");
+        return 0;
+    }
+
+    livings = allocate(count);
+    index = -1;
+    while(++index < count)
+    {
+        livings[index] = clone_object(MONSTER_OBJECT);
+    }
+    total = count * each;
+
+    /* Trigger all cooldowns with random durations. */
+    start = gettimeofday();
+    key = -1;
+    while(++key < each)
+    {
+        foreach(object living: livings)
+        {
+            living->trigger_cooldown(BENCH_KEY + key,
+                ((key % BENCH_EXPIRED) ? (60.0 + itof(random(600))) : 0.0));
+        }
+    }
+    trigger_time = gettimeofday() - start;
+
+    /* Extend half of them, which moves them down in the heap. */
+    start = gettimeofday();
+    key = -1;
+    while(++key < each)
+    {
+        if (key % 2)
+        {
+            foreach(object living: livings)
+            {
+                living->trigger_cooldown(BENCH_KEY + key, 3600.0);
+            }
+            refreshed += count;
+        }
+    }
+    refresh_time = gettimeofday() - start;
+
+    start = gettimeofday();
+    round = -1;
+    while(++round < BENCH_QUERIES)
+    {
+        key = -1;
+        while(++key < each)
+        {
+            foreach(object living: livings)
+            {
+                if (living->query_cooldown(BENCH_KEY + key) !=
+                    !!(key % BENCH_EXPIRED))
+                {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    query_time = gettimeofday() - start;
+
+    foreach(object living: livings)
+    {
+        living->remove_object();
+    }
+
+    write(sprintf("%d livings with %d cooldowns, %d in total.\n" +
+        "Trigger: %.4f seconds (%.1f usec per cooldown).\n" +
+        "Refresh: %.4f seconds (%.1f usec per cooldown).\n" +
+        "Query:   %.4f seconds (%.1f usec per query).\n",
+        count, each, total,
+        trigger_time, trigger_time * 1000000.0 / itof(total),
+        refresh_time, refresh_time * 1000000.0 / itof(max(1, refreshed)),
+        query_time,
+        query_time * 1000000.0 / itof(total * BENCH_QUERIES)));
+    if (mismatches)
+    {
+        write("Mismatch! " + mismatches + " queries gave the wrong " +
+            "answer.\n");
+    }
+
+    return 1;
+}
@@ -75,6 +75,12 @@ query_mail(mixed player = this_player())
 	return 0;
     }
 
+    /* Mail in the journal is always new mail. */
+    if (file_size(FILE_NAME_JOURNAL(player)) > 0)
+    {
+	return FLAG_NEW;
+    }
+
     /* If something is wrong with the mail-file, there is no mail for
      * the player.
      */
@@ -342,6 +342,9 @@ static void
 save_mail(mapping mail, string name)
 {
     save_map(mail, FILE_NAME_MAIL(name));
+
+    /* Messages may have been deleted, so the spool must count anew. */
+    MAIL_SPOOL->forget_mail_count(name);
 }
 
 
@@ -396,6 +399,8 @@ static void
 load_player()
 {
     mapping mail;
+    mapping *journal;
+    string  name;
     int     index;
 
     /* Only the environment of the reader can initiate a read since the
@@ -407,7 +412,16 @@ load_player()
         return;
     }
 
-    mail = restore_mail(environment()->query_real_name());
+    name = environment()->query_real_name();
+    mail = restore_mail(name);
+
+    /* Merge the mail that was delivered since the mailbox was last saved. */
+    journal = MAIL_SPOOL->read_journal(name);
+    if (sizeof(journal))
+    {
+        mail[MAIL_MAIL] += journal;
+        mail[MAIL_NEW_MAIL] = FLAG_NEW;
+    }
 
     gLoaded  = 1;
 
@@ -424,6 +438,12 @@ load_player()
         UPDATE_GMCP_MAIL_FLAG;
     }
 
+    /* The journal is part of the saved mailbox now. */
+    if (sizeof(journal))
+    {
+        MAIL_SPOOL->remove_journal(name);
+    }
+
 #ifdef MAX_IN_MORTAL_BOX
     /* Count the number of messages in the mailbox of the player. Messages
      * that are answered, count as read as well.
@@ -1914,113 +1934,14 @@ unstar(int *mark_arr)
 }
 
 
-/*
- * Function name: send_mail_safely
- * Description  : This is the function that actually sends the mail in
- *                small portions. We do not want to run into eval-cost
- *                limits.
- * Arguments    : string *dest_array - the people to send the mail to.
- *                string name - the (capitalized) name of the author.
- */
-static void
-send_mail_safely(string *dest_array, string name)
-{
-    int     index;
-    int     max = MIN(sizeof(dest_array), MAX_CYCLE);
-    mapping player_mail;
-    string  recipient;
-    object  obj;
-
-    /* No recipients (VERY strange). */
-    if (max <= 0)
-    {
-        gBusy = 0;
-        WRITE("No mail sent.\n");
-        loop();
-        return;
-    }
-
-    index = -1;
-    while(++index < max)
-    {
-        recipient = lower_case(dest_array[index]);
-
-        /* Restore the mailbox of the player. */
-        player_mail = restore_mail(recipient);
-
-        /* Add the message to the mailbox of the player and set the
-         * new-mail-flag to new mail.
-         */
-        player_mail[MAIL_MAIL] += ({ gTo_send });
-        player_mail[MAIL_NEW_MAIL] = FLAG_NEW;
-
-        /* Save the mailbox of the player. */
-        save_mail(player_mail, recipient);
-
-        /* Tell the target he has new mail and if necessary notify the
-         * mailreader s/he is carrying.
-         */
-        if (objectp(obj = find_player(recipient)))
-        {
-            /* Tell only wizards the subject to refrain mortal players from
-             * using the mailreader as a tell-line. Rather, mortals get to
-             * see the subject too if the author is a wizard.
-             */
-            if (environment()->query_wiz_level() || obj->query_wiz_level())
-                tell_object(obj,
-                    "\nPostmaster tells you that you have new mail (# " +
-                    sizeof(player_mail[MAIL_MAIL]) + ") from " + name +
-                    ",\nconcerning " +
-                    SUBJECT_SHORT[gTo_send[MAIL_REPLY]] + ": " +
-                    gSubject + " (" + gTo_send[MAIL_LENGTH] + ")\n\n");
-            else
-                tell_object(obj,
-                    "\nPostmaster tells you that you have new mail from " +
-                    name + ".\n\n");
-
-            /* GMCP */
-            if (obj->query_gmcp(GMCP_CHAR))
-            {
-                obj->gmcp_char(GMCP_CHAR_STATUS, GMCP_MAIL, MAIL_FLAGS[FLAG_NEW]);
-            }
-
-            /* If the player is carrying a mailreader, invalidate it, so
-             * that the player cannot destruct the message by accident.
-             */
-            if (objectp(obj = present(READER_ID, obj)))
-            {
-                obj->invalidate();
-            }
-
-        }
-    }
-
-    WRITE(HANGING_INDENT("Batch sent to: " +
-        COMPOSITE_WORDS(dest_array[0..(max - 1)]) + ".", 4, 0));
-
-    dest_array = dest_array[max..];
-
-    /* If there are more recipients, put in a new alarm, if not,
-     * unset gBusy to allow operation of the reader again.
-     */
-    if (sizeof(dest_array))
-        set_alarm(1.0, 0.0, &send_mail_safely(dest_array, name));
-    else
-    {
-        WRITE("Mail sent.\n");
-        gBusy = 0;
-        loop();
-    }
-}
-
-
 /*
  * Function name: send_mail
  * Description  : This function sends the mail to the recipients and
  *                makes sure that if people are reading mail their readers
- *                are notified. To avoid the "evaluation too long" error,
- *                send_mail_safely is called to store the message in the
- *                destinations mail-files.
+ *                are notified. The message is handed to the mail spool,
+ *                which appends it to the journals of the recipients. Big
+ *                mailing lists are delivered by the spool in the
+ *                background.
  * Arguments    : string name - the (capitalized) name of the author.
  */
 static void
@@ -2028,6 +1949,7 @@ send_mail(string name)
 {
     int     send_time = time();
     int     length    = sizeof(explode(gMessage, "\n"));
+    int     delivered;
     string *addressees;
 
     /* Set a flag so the main loop won't start yet. It disallows
@@ -2107,10 +2029,27 @@ send_mail(string name)
                                     sprintf("%2d", length)),
                   MAIL_READ   : MSG_UNREAD ]);
 
-    if (sizeof(addressees) > MAX_CYCLE)
-        WRITE("Busy sending mail. Please wait.\n");
+    /* No recipients (VERY strange). */
+    if (!sizeof(addressees))
+    {
+        gBusy = 0;
+        WRITE("No mail sent.\n");
+        loop();
+        return;
+    }
+
+    delivered = MAIL_SPOOL->deliver(gTo_send, addressees, name,
+        environment()->query_wiz_level());
 
-    send_mail_safely(addressees, name);
+    if (delivered && (delivered < sizeof(addressees)))
+        WRITE(HANGING_INDENT("Mail sent to: " +
+            COMPOSITE_WORDS(addressees[..(delivered - 1)]) +
+            ". The others will receive it shortly.", 4, 0));
+    else
+        WRITE("Mail sent.\n");
+
+    gBusy = 0;
+    loop();
 }
 
 
@@ -0,0 +1,436 @@
+/*
+ * /secure/mail_spool.c
+ *
+ * The mail spool delivers new mail to the mailboxes of the recipients.
+ *
+ * Rather than restoring and saving the complete mailbox of each recipient,
+ * the header of a new message is appended to the mail journal of the
+ * recipient. This is a single line in a separate file next to the mailbox.
+ * The journal is merged into the mailbox when the recipient next loads his
+ * or her mail in the mail reader.
+ *
+ * The first MAX_CYCLE recipients of a message are served at once. Mail to
+ * more people is delivered by the spool in batches of MAX_SPOOL from an
+ * alarm, so that the mail reader of the author is not blocked while a big
+ * mailing list is served. The pending deliveries are saved, so they will
+ * survive a reboot.
+ *
+ * The journal is a line per message with the fields separated by a tab:
+ *
+ *     <date> <reply flag> <length> <author> <subject>
+ *
+ * Only the mail reader and the master may use this object.
+ */
+
+#pragma no_clone
+#pragma no_inherit
+#pragma no_shadow
+#pragma save_binary
+#pragma strict_types
+
+#include <files.h>
+#include <gmcp.h>
+#include <macros.h>
+#include <mail.h>
+#include <std.h>
+
+#define SPOOL_FILE  (MAIL_DIR + "spool")
+#define SPOOL_DELAY (1.0)
+
+#define JOB_HEADER  0   /* The message header for the mailboxes.   */
+#define JOB_NAMES   1   /* The recipients still to serve.          */
+#define JOB_AUTHOR  2   /* The capitalized name of the author.     */
+#define JOB_WIZARD  3   /* Whether the author is a wizard.         */
+
+#define CHECK_CALLER                                      \
+    if ((MASTER_OB(previous_object()) != MAIL_READER) &&  \
+        (previous_object() != find_object(SECURITY)))     \
+        return 0;
+
+/*
+ * Global variables.
+ *
+ * spool_jobs  - the deliveries still to be done.
+ * spool_alarm - the alarm-id of the delivery alarm.
+ * mail_counts - ([ name : count ]) the number of messages of the players
+ *               in the game, so the mailbox is not restored for every
+ *               message they get. A count is forgotten when the mail
+ *               reader saves the mailbox, or when the player is gone.
+ */
+static private mixed   spool_jobs = ({ });
+static private int     spool_alarm;
+static private mapping mail_counts = ([ ]);
+
+/*
+ * Prototypes.
+ */
+static void spool_run();
+
+/*
+ * Function name: create
+ * Description  : Constructor. Restores the deliveries that were pending
+ *                when the spool was last destructed.
+ */
+nomask void
+create()
+{
+    mapping spool;
+
+    setuid();
+    seteuid(getuid());
+
+    if (file_size(SPOOL_FILE + ".o") > 0)
+    {
+        catch(spool = restore_map(SPOOL_FILE));
+        if (mappingp(spool) && pointerp(spool["jobs"]))
+        {
+            spool_jobs = spool["jobs"];
+        }
+    }
+
+    if (sizeof(spool_jobs))
+    {
+        spool_alarm = set_alarm(SPOOL_DELAY, 0.0, spool_run);
+    }
+}
+
+/*
+ * Function name: short
+ * Description  : Returns the short description for this object.
+ * Returns      : string - the short description.
+ */
+nomask string
+short()
+{
+    return "the mail spool";
+}
+
+/*
+ * Function name: save_spool
+ * Description  : Save the pending deliveries to disk, or remove the file
+ *                when there are none.
+ */
+static void
+save_spool()
+{
+    if (sizeof(spool_jobs))
+    {
+        save_map( ([ "jobs" : spool_jobs ]), SPOOL_FILE);
+    }
+    else if (file_size(SPOOL_FILE + ".o") >= 0)
+    {
+        rm(SPOOL_FILE + ".o");
+    }
+}
+
+/*
+ * Function name: parse_journal
+ * Description  : Read the headers of the messages in the journal of a
+ *                player.
+ * Arguments    : string name - the name of the player.
+ * Returns      : mapping * - the headers in the order they were sent.
+ */
+static mapping *
+parse_journal(string name)
+{
+    string  text;
+    string *fields;
+    mapping *headers = ({ });
+
+    if (file_size(FILE_NAME_JOURNAL(name)) <= 0)
+    {
+        return ({ });
+    }
+
+    text = read_file(FILE_NAME_JOURNAL(name));
+    if (!strlen(text))
+    {
+        return ({ });
+    }
+
+    foreach(string line: explode(text, "\n"))
+    {
+        fields = explode(line, "\t");
+        if (sizeof(fields) < 5)
+        {
+            continue;
+        }
+
+        headers += ({ ([ MAIL_DATE   : atoi(fields[0]),
+                         MAIL_REPLY  : atoi(fields[1]),
+                         MAIL_LENGTH : fields[2],
+                         MAIL_FROM   : fields[3],
+                         MAIL_SUBJ   : implode(fields[4..], "\t"),
+                         MAIL_READ   : MSG_UNREAD ]) });
+    }
+
+    return headers;
+}
+
+/*
+ * Function name: read_journal
+ * Description  : Get the headers of the messages in the journal of a
+ *                player, to merge them into his or her mailbox.
+ * Arguments    : string name - the name of the player.
+ * Returns      : mapping * - the headers in the order they were sent.
+ */
+public mapping *
+read_journal(string name)
+{
+    CHECK_CALLER;
+
+    return parse_journal(name);
+}
+
+/*
+ * Function name: remove_journal
+ * Description  : Remove the journal of a player after it was merged into
+ *                the mailbox of the player.
+ * Arguments    : string name - the name of the player.
+ * Returns      : int 1/0 - removed/not removed.
+ */
+public int
+remove_journal(string name)
+{
+    CHECK_CALLER;
+
+    if (file_size(FILE_NAME_JOURNAL(name)) < 0)
+    {
+        return 0;
+    }
+
+    return rm(FILE_NAME_JOURNAL(name));
+}
+
+/*
+ * Function name: query_mail_count
+ * Description  : Find out how many messages a player has, counting the
+ *                mailbox and the journal.
+ * Arguments    : string name - the name of the player.
+ * Returns      : int - the number of messages.
+ */
+static int
+query_mail_count(string name)
+{
+    mapping mail = restore_map(FILE_NAME_MAIL(name));
+    int     count;
+
+    if (mappingp(mail) && pointerp(mail[MAIL_MAIL]))
+    {
+        count = sizeof(mail[MAIL_MAIL]);
+    }
+
+    return count + sizeof(parse_journal(name));
+}
+
+/*
+ * Function name: forget_mail_count
+ * Description  : Called from the mail reader when it saves the mailbox of
+ *                a player, since messages may have been deleted.
+ * Arguments    : string name - the name of the player.
+ */
+public void
+forget_mail_count(string name)
+{
+    if (MASTER_OB(previous_object()) != MAIL_READER)
+    {
+        return;
+    }
+
+    m_delkey(mail_counts, name);
+}
+
+/*
+ * Function name: deliver_one
+ * Description  : Append a message to the journal of a recipient and tell
+ *                the recipient about it if he or she is in the game.
+ * Arguments    : mixed job - the delivery.
+ *                string recipient - the (lower case) name of the recipient.
+ */
+static void
+deliver_one(mixed job, string recipient)
+{
+    mapping header = job[JOB_HEADER];
+    object  obj;
+
+    /* Make sure there is a mailbox, or the mail administrator would not
+     * find the recipient.
+     */
+    if (file_size(FILE_NAME_MAIL(recipient) + ".o") <= 0)
+    {
+        save_map( ([ MAIL_MAIL     : ({ }),
+                     MAIL_ALIASES  : ([ ]),
+                     MAIL_NEW_MAIL : FLAG_NEW,
+                     MAIL_AUTO_CC  : 0 ]), FILE_NAME_MAIL(recipient));
+    }
+
+    write_file(FILE_NAME_JOURNAL(recipient),
+        sprintf("%d\t%d\t%s\t%s\t%s\n", header[MAIL_DATE],
+        header[MAIL_REPLY], header[MAIL_LENGTH], header[MAIL_FROM],
+        implode(explode(header[MAIL_SUBJ], "\n"), " ")));
+
+    if (!objectp(obj = find_player(recipient)))
+    {
+        m_delkey(mail_counts, recipient);
+        return;
+    }
+
+    /* The count includes the message we just added to the journal. */
+    if (mail_counts[recipient])
+    {
+        mail_counts[recipient]++;
+    }
+    else
+    {
+        mail_counts[recipient] = query_mail_count(recipient);
+    }
+
+    /* Tell only wizards the subject to refrain mortal players from using
+     * the mailreader as a tell-line. Rather, mortals get to see the subject
+     * too if the author is a wizard.
+     */
+    if (job[JOB_WIZARD] || obj->query_wiz_level())
+        tell_object(obj,
+            "\nPostmaster tells you that you have new mail (# " +
+            mail_counts[recipient] + ") from " + job[JOB_AUTHOR] +
+            ",\nconcerning " + SUBJECT_SHORT[header[MAIL_REPLY]] + ": " +
+            header[MAIL_SUBJ] + " (" + header[MAIL_LENGTH] + ")\n\n");
+    else
+        tell_object(obj,
+            "\nPostmaster tells you that you have new mail from " +
+            job[JOB_AUTHOR] + ".\n\n");
+
+    /* GMCP */
+    if (obj->query_gmcp(GMCP_CHAR))
+    {
+        obj->gmcp_char(GMCP_CHAR_STATUS, GMCP_MAIL, MAIL_FLAGS[FLAG_NEW]);
+    }
+
+    /* If the player is carrying a mailreader, invalidate it, so that it
+     * picks up the journal.
+     */
+    if (objectp(obj = present(READER_ID, obj)))
+    {
+        obj->invalidate();
+    }
+}
+
+/*
+ * Function name: deliver
+ * Description  : Deliver a message to its recipients. The first MAX_CYCLE
+ *                recipients are served at once, the others are spooled.
+ * Arguments    : mapping header - the header for the mailboxes.
+ *                string *names - the names of the recipients.
+ *                string author - the (capitalized) name of the author.
+ *                int wizard - true if the author is a wizard.
+ * Returns      : int - the number of recipients served at once.
+ */
+public int
+deliver(mapping header, string *names, string author, int wizard)
+{
+    mixed job;
+    int   size;
+
+    CHECK_CALLER;
+
+    job = ({ header + ([ ]), map(names, lower_case), author, wizard });
+    size = min(sizeof(names), MAX_CYCLE);
+
+    foreach(string recipient: job[JOB_NAMES][..(size - 1)])
+    {
+        deliver_one(job, recipient);
+    }
+
+    if (sizeof(names) > size)
+    {
+        job[JOB_NAMES] = job[JOB_NAMES][size..];
+        spool_jobs += ({ job });
+        save_spool();
+
+        if (!spool_alarm)
+        {
+            spool_alarm = set_alarm(SPOOL_DELAY, 0.0, spool_run);
+        }
+    }
+
+    return size;
+}
+
+/*
+ * Function name: spool_run
+ * Description  : Deliver the next batch of spooled mail.
+ */
+static void
+spool_run()
+{
+    mixed job;
+    int   count, size;
+
+    spool_alarm = 0;
+
+    while(sizeof(spool_jobs) && (count < MAX_SPOOL))
+    {
+        job = spool_jobs[0];
+        size = min(sizeof(job[JOB_NAMES]), MAX_SPOOL - count);
+        foreach(string recipient: job[JOB_NAMES][..(size - 1)])
+        {
+            catch(deliver_one(job, recipient));
+        }
+        count += size;
+
+        job[JOB_NAMES] = job[JOB_NAMES][size..];
+        if (!sizeof(job[JOB_NAMES]))
+        {
+            spool_jobs = spool_jobs[1..];
+        }
+    }
+
+    save_spool();
+
+    if (sizeof(spool_jobs))
+    {
+        spool_alarm = set_alarm(SPOOL_DELAY, 0.0, spool_run);
+    }
+}
+
+/*
+ * Function name: query_spooled
+ * Description  : Find out how many deliveries are still pending.
+ * Returns      : int - the number of recipients not yet served.
+ */
+public int
+query_spooled()
+{
+    int count;
+
+    foreach(mixed job: spool_jobs)
+    {
+        count += sizeof(job[JOB_NAMES]);
+    }
+
+    return count;
+}
+
+/*
+ * Function name: remove_object
+ * Description  : Save the pending deliveries before we are destructed.
+ * Returns      : int 1 - always.
+ */
+nomask int
+remove_object()
+{
+    save_spool();
+    destruct();
+    return 1;
+}
+
+/*
+ * Function name: query_prevent_shadow
+ * Description  : Prevent shadowing of this object.
+ * Returns      : int 1 - always.
+ */
+nomask int
+query_prevent_shadow()
+{
+    return 1;
+}
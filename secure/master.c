@@ -46,6 +46,7 @@
 #define DEBUG_RESTRICTED ( ({ "mudstatus", "swap", "shutdown", "send_udp", "update snoops", "dump_alarms", "dump_objects", "trace_calls" }) )
 #define DEBUG_BLOCKED    ( ({ }) )
 #define RESET_TIME (900.0) /* 15 minutes */
+#define ACCESS_CACHE_MAX (2000) /* Decisions kept by valid_read/write. */
 
 /* All prototypes have been placed in /secure/master.h */
 #include "/secure/master.h"
@@ -61,6 +62,7 @@
 #include "/secure/master/guild.c"
 #include "/secure/master/mail_admin.c"
 #include "/secure/master/gmcp.c"
+#include "/secure/master/syslog.c"
 
 /*
  * The global variables that are saved in the SAVEFILE.
@@ -81,6 +83,17 @@ private static int     uptime_limit;
 private static string  mudlib_version;
 private static int     game_start_time;
 
+/*
+ * The decisions of valid_read() and valid_write() are kept, keyed by the
+ * operation, the euid and the directory, or the file in the domains. They are flushed whenever the
+ * wizards, domains, teams or sanctions change.
+ *
+ * m_access_cache - ([ string key : int decision + 1 ])
+ * access_stats   - ({ int hits, int misses, int flushes })
+ */
+private static mapping m_access_cache = ([ ]);
+private static int    *access_stats = ({ 0, 0, 0 });
+
 /*
  * Function name: create
  * Description  : This is the first function called in this object.
@@ -157,6 +170,9 @@ save_master()
     set_auth(this_object(), "root:root");
 
     save_object(SAVEFILE);
+
+    /* Whatever changed may alter the access rights. */
+    flush_access_cache();
 }
 
 /*
@@ -364,10 +380,14 @@ get_vbfc_object()
 static object
 connect()
 {
+    object ob;
+
     write("\n");
     set_auth(this_object(), "root:root");
 
-    return clone_object(LOGIN_OBJECT);
+    ob = clone_object(LOGIN_OBJECT);
+    QUEUE->connect_slot(ob);
+    return ob;
 }
 
 
@@ -477,10 +497,133 @@ valid_seteuid(object ob, string str)
     return 0;
 }
 
+/*
+ * Function name: flush_access_cache
+ * Description  : Forget all decisions of valid_read() and valid_write().
+ */
+static void
+flush_access_cache()
+{
+    if (m_sizeof(m_access_cache))
+    {
+        m_access_cache = ([ ]);
+        access_stats[2]++;
+    }
+}
+
+/*
+ * Function name: query_access_cache_stats
+ * Description  : Gives the statistics of the cache of valid_read() and
+ *                valid_write() decisions.
+ * Returns      : mapping - the statistics.
+ */
+public mapping
+query_access_cache_stats()
+{
+    int total = access_stats[0] + access_stats[1];
+
+    return ([ "entries"  : m_sizeof(m_access_cache),
+              "hits"     : access_stats[0],
+              "misses"   : access_stats[1],
+              "flushes"  : access_stats[2],
+              "hit rate" : (total ? ((access_stats[0] * 100) / total) : 0) ]);
+}
+
+/*
+ * Function name: access_cache_key
+ * Description  : Find the key under which the decision for a file can be
+ *                kept. Decisions are kept per directory, so this is only
+ *                possible for files deep enough in the tree that the rules
+ *                do not look at the name of the file itself. Domain code
+ *                accessing its own domain is not kept either, since the
+ *                team directories look at the path of the object. In the
+ *                domains, the directory sanctions are checked for every
+ *                directory in the path including the last part, so there
+ *                the decision is kept for the full path of the file.
+ * Arguments    : string op - "r" or "w".
+ *                string file - the file to access.
+ *                string euid - the euid of the accessor.
+ * Returns      : string - the key, or 0 if the decision cannot be kept.
+ */
+static string
+access_cache_key(string op, string file, string euid)
+{
+    string *dirs;
+    int    size;
+
+    if (!stringp(euid) || !strlen(euid))
+    {
+        return 0;
+    }
+
+    dirs = explode(file, "/") - ({ "" });
+    if (!(size = sizeof(dirs)))
+    {
+        return 0;
+    }
+
+    switch(dirs[0])
+    {
+    case "d":
+        if ((size < 6) || (dirs[1] == euid))
+        {
+            return 0;
+        }
+        return op + euid + ":" + implode(dirs, "/");
+
+    case "w":
+        /* Writing checks for a private directory at the fourth level, so
+         * that must not be the name of the file.
+         */
+        if ((size < 4) || ((op == "w") && (size < 5)))
+        {
+            return 0;
+        }
+        break;
+
+    default:
+        if (size < 4)
+        {
+            return 0;
+        }
+    }
+
+    return op + euid + ":" + implode(dirs[..-2], "/");
+}
+
+/*
+ * Function name: cached_access
+ * Description  : Look up a decision in the cache, or make and keep it.
+ * Arguments    : string key - the key from access_cache_key().
+ *                function decide - makes the decision when needed.
+ * Returns      : int 1/0 - allowed/disallowed.
+ */
+static int
+cached_access(string key, function decide)
+{
+    int result;
+
+    if (result = m_access_cache[key])
+    {
+        access_stats[0]++;
+        return (result - 1);
+    }
+
+    access_stats[1]++;
+    result = decide();
+
+    if (m_sizeof(m_access_cache) >= ACCESS_CACHE_MAX)
+    {
+        m_access_cache = ([ ]);
+    }
+    m_access_cache[key] = (result ? 2 : 1);
+    return (result ? 1 : 0);
+}
+
 /*
  * Function name: valid_write
  * Description  : Checks whether a certain user has the right to write a
- *                particular file.
+ *                particular file. The decision is kept when possible.
  * Arguments    : string path  - the path name of the file to be write.
  *                mixed writer - the name or object of the writer.
  *                string func  - the calling function.
@@ -488,6 +631,29 @@ valid_seteuid(object ob, string str)
  */
 int
 valid_write(string file, mixed writer, string func)
+{
+    string key = access_cache_key("w", file,
+        (objectp(writer) ? geteuid(writer) : writer));
+
+    if (!key)
+    {
+        return decide_write(file, writer, func);
+    }
+
+    return cached_access(key, &decide_write(file, writer, func));
+}
+
+/*
+ * Function name: decide_write
+ * Description  : Checks whether a certain user has the right to write a
+ *                particular file.
+ * Arguments    : string path  - the path name of the file to be write.
+ *                mixed writer - the name or object of the writer.
+ *                string func  - the calling function.
+ * Returns      : int 1/0 - allowed/disallowed.
+ */
+static int
+decide_write(string file, mixed writer, string func)
 {
     string *dirs, *wpath;
     string dname;
@@ -675,6 +841,7 @@ valid_write(string file, mixed writer, string func)
 /*
  * Function name: valid_read
  * Description  : Checks if a certain user has the right to read a file.
+ *                The decision is kept when possible.
  * Arguments    : string path  - path name of the file to be read.
  *                mixed reader - the object or name of the reader.
  *                string func  - the calling function.
@@ -682,6 +849,36 @@ valid_write(string file, mixed writer, string func)
  */
 int
 valid_read(string file, mixed reader, string func)
+{
+    string key;
+
+    /* Everyone is allowed to see the time or size of a file. */
+    if ((func == "file_time") ||
+        (func == "file_size"))
+    {
+        return 1;
+    }
+
+    key = access_cache_key("r", file,
+        (objectp(reader) ? geteuid(reader) : reader));
+    if (!key)
+    {
+        return decide_read(file, reader, func);
+    }
+
+    return cached_access(key, &decide_read(file, reader, func));
+}
+
+/*
+ * Function name: decide_read
+ * Description  : Checks if a certain user has the right to read a file.
+ * Arguments    : string path  - path name of the file to be read.
+ *                mixed reader - the object or name of the reader.
+ *                string func  - the calling function.
+ * Returns      : int 1/0 - allowed/disallowed.
+ */
+static int
+decide_read(string file, mixed reader, string func)
 {
     string *dirs, *rpath;
     string dname;
@@ -1539,8 +1736,6 @@ start_boot(int no_preload)
     init_player_info();
     /* Remove orphan mail files from the website. */
     web_mail_archive_clean();
-    /* Initialize GMCP. */
-    init_gmcp();
 
     if (no_preload)
     {
@@ -1715,6 +1910,9 @@ final_shutdown()
     /* Process the graph data even if this isn't the top of the hour. */
     graph_process_data();
 
+    /* Write whatever is still waiting in the log buffers. */
+    flush_syslogs();
+
     /* It's a proper shutdown, so we are not started. */
     game_started = 0;
     /* Save the master. */
@@ -1891,18 +2089,22 @@ query_allow_shadow(object target)
  *                      The program name is what calling_program returns.
  *                to:   destination of socket
  *                from: target of the socket
+ *                The login queue is told that the slot in the game moves
+ *                along with the socket.
  * Returns:       True if exec() is allowed.
  */
 int
 valid_exec(string name, object to, object from)
 {
+    int allowed;
+
     name = "/" + name;
     if ((name == (LOGIN_OBJECT + ".c")) ||
         (name == (POSSESSION_OBJECT + ".c")) ||
         (name == (LOGIN_TEST_PLAYER + ".c")) ||
         (name == (LOGIN_NEW_PLAYER + ".c")))
     {
-        return 1;
+        allowed = 1;
     }
 
     /* Allow shapeshift to occur. */
@@ -1910,12 +2112,17 @@ valid_exec(string name, object to, object from)
         (name == "/d/Genesis/specials/std/spells/obj/shapeshift_obj.c"))
     {
         if (IS_PLAYER_OBJECT(from) && IS_CREATE_SOME(to, "create_creature", "/d/Genesis/race/shapeshift/shapeshift_creature"))
-            return 1;
+            allowed = 1;
         if (IS_PLAYER_OBJECT(to) && IS_CREATE_SOME(from, "create_creature", "/d/Genesis/race/shapeshift/shapeshift_creature"))
-            return 1;
+            allowed = 1;
     }
 
-    return 0;
+    if (allowed)
+    {
+        QUEUE->exec_slot(to, from);
+    }
+
+    return allowed;
 }
 
 /*
@@ -2884,6 +3091,7 @@ remove_playerfile(string pname, string reason, int silent)
     {
         return 0;
     }
+    remove_player_index(pname);
 
     if (CALL_BY_SELF)
 	wname = "Root";
@@ -2949,6 +3157,8 @@ rename_playerfile(string oldname, string newname)
     playerfile = restore_map(PLAYER_FILE(newname));
     playerfile["name"] = newname;
     save_map(playerfile, PLAYER_FILE(newname));
+    remove_player_index(oldname);
+    query_player_index(newname);
     text = "Player " + capitalize(oldname) + " succesfully renamed to " +
         capitalize(newname) + ".\n";
 
@@ -2964,6 +3174,12 @@ rename_playerfile(string oldname, string newname)
         {
             text += "Mail folder found, but renaming failed.\n";
         }
+
+        /* Take the mail that was not merged yet along. */
+        if (file_size(FILE_NAME_JOURNAL(oldname)) > 0)
+        {
+            rename(FILE_NAME_JOURNAL(oldname), FILE_NAME_JOURNAL(newname));
+        }
     }
     else
     {
@@ -3208,6 +3424,10 @@ save_player()
     export_uid(pobj);
     res = (int)pobj->save_player(pobj->query_real_name());
     pobj->open_player();
+    if (res)
+    {
+        index_player_object(pobj);
+    }
     set_auth(this_object(), "#:" + (pobj->query_wiz_level() ?
         pobj->query_real_name() : BACKBONE_UID));
     export_uid(pobj);
@@ -3265,6 +3485,14 @@ log_syslog(string file, string text, int length = 0)
         return;
     }
 
+#ifdef LOG_BUFFERED
+    if (member_array(file, LOG_BUFFERED) >= 0)
+    {
+        buffer_syslog(file, text, length);
+        return;
+    }
+#endif LOG_BUFFERED
+
     log_file(file, text, length);
 }
 
@@ -20,6 +20,9 @@ public int valid_player_info(mixed actor, string name, string func);
 varargs int valid_query_ip(mixed actor, object target);
 int valid_read(string file, mixed reader, string func);
 int valid_write(string file, mixed writer, string func);
+static void flush_access_cache();
+static int decide_read(string file, mixed reader, string func);
+static int decide_write(string file, mixed writer, string func);
 int exist_player(string pl_name);
 public int query_start_time();
 
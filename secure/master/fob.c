@@ -2203,6 +2203,9 @@ do_change_rank(string wname, int rank, string cmder)
 
     save_master();
 
+    /* The login queue counts wizards differently. */
+    QUEUE->update_rank(wname);
+
     if (objectp(wizard))
     {
         wizard->reset_userids();
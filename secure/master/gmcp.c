@@ -8,31 +8,8 @@
 #include "/sys/gmcp.h"
 #include "/sys/ss_types.h"
 
-static int     gmcp_alarm;
 static mapping gmcp_tokens = ([ ]);
 
-/*
- * Function name: gmcp_refresh
- * Description  : This routine is called from the GMCP alarm in order to cause
- *                the GMCP values to be updated.
- */
-public void
-gmcp_refresh()
-{
-    users()->gmcp_refresh();
-}
-
-/* 
- * Function name: init_gmcp
- * Description  : Called when the gamedriver is loaded.
- */
-static void
-init_gmcp()
-{
-    /* The alarm needed to cause the GMCP indicators of players to go up. */
-    gmcp_alarm = set_alarm(GMCP_INTERVAL, GMCP_INTERVAL, gmcp_refresh);
-}
-
 /*
  * Function name: query_gmcp_token_user
  * Description  : Find out the player that belongs to a certain GMCP token.
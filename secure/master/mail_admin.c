@@ -49,7 +49,9 @@ static private int     mail_alarm   = 0;
 
 /*
  * Function name: restore_mail
- * Description  : Restore the mail-file of a player from disk.
+ * Description  : Restore the mail-file of a player from disk. The mail in
+ *                the journal of the player is included, but the journal is
+ *                left in place for the mail reader to merge.
  * Arguments    : string name - the name of the player.
  * Returns      : mapping     - the mail of the player.
  */
@@ -66,6 +68,7 @@ restore_mail(string name)
 	return 0;
     }
 
+    mail[MAIL_MAIL] += MAIL_SPOOL->read_journal(name);
     return mail;
 }
 
@@ -461,6 +464,7 @@ purge_check_mailboxes(int full)
         foreach(string file: purge_files)
         {
             rm(FILE_NAME_MAIL(file));
+            MAIL_SPOOL->remove_journal(file[..-3]);
         }
     }
 
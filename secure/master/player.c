@@ -6,12 +6,15 @@
  * inappropriate names.
  */
 
+#include "/sys/formulas.h"
 #include "/sys/log.h"
+#include "/sys/options.h"
 
 #define PREDEATH_CLEANUP 31536000 /* one year */
 #define BAD_NAME_CLEANUP  1209600 /* two weeks */
 #define NEW_CHAR_CLEANUP  1209600 /* two weeks */
 #define NEW_CHAR_MINAGE      3600 /* two hours in heartbeats */
+#define PLAYER_INDEX_DELAY  300.0 /* five minutes */
 
 /* Indices to the m_seconds mapping. */
 #define SNDS_REPORTER 0
@@ -52,6 +55,22 @@ private mapping m_badnames = ([ ]);
  */
 private mapping m_newchars = ([ ]);
 
+/*
+ * At run-time we keep an index with the information from the playerfiles
+ * that is needed to judge many players at once, like for the purge, or to
+ * answer simple questions about a player without cloning a finger player.
+ * It is saved in PLAYER_INDEX_SAVE a while after it changed. An entry is
+ * only trusted while the file time of the playerfile matches, so changes
+ * made to a playerfile by other means are picked up as well.
+ *
+ * m_pindex = ([ (string) player :
+ *               ({ (int) file time, (int) file size, (int) login time,
+ *                  (int) logout time, (int) age, (int) wiz rank,
+ *                  (int) restricted, (int) average stat }) ])
+ */
+static private mapping m_pindex = ([ ]);
+static private int     pindex_alarm;
+
 /*
  * Function name: save_seconds
  * Description  : Since the seconds information is stored in a separate
@@ -64,6 +83,169 @@ save_seconds()
     save_map(m_seconds, SECONDS_SAVE);
 }
 
+/*
+ * Function name: save_player_index
+ * Description  : Save the player index to disk.
+ */
+static void
+save_player_index()
+{
+    pindex_alarm = 0;
+    set_auth(this_object(), "root:root");
+    save_map(m_pindex, PLAYER_INDEX_SAVE);
+}
+
+/*
+ * Function name: player_index_changed
+ * Description  : Called when the player index changed. It is saved a while
+ *                later, so many changes are written at once.
+ */
+static void
+player_index_changed()
+{
+    if (!pindex_alarm)
+    {
+        pindex_alarm = set_alarm(PLAYER_INDEX_DELAY, 0.0, save_player_index);
+    }
+}
+
+/*
+ * Function name: read_player_index
+ * Description  : Make the index entry for a player from the playerfile.
+ * Arguments    : string name - the lower case name of the player.
+ * Returns      : mixed - the entry, or 0 if there is no valid playerfile.
+ */
+static mixed
+read_player_index(string name)
+{
+    mapping playerfile;
+    mixed   acc_exp;
+    int     average;
+    int     ftime;
+
+    set_auth(this_object(), "root:root");
+    if ((ftime = file_time(PLAYER_FILE(name) + ".o")) <= 0)
+    {
+        return 0;
+    }
+
+    catch(playerfile = restore_map(PLAYER_FILE(name)));
+    if (!mappingp(playerfile) ||
+        (playerfile["name"] != name))
+    {
+        return 0;
+    }
+
+    acc_exp = playerfile["acc_exp"];
+    if (pointerp(acc_exp) && (sizeof(acc_exp) >= SS_NO_EXP_STATS))
+    {
+        for (int stat = 0; stat < SS_NO_EXP_STATS; stat++)
+        {
+            average += F_EXP_TO_STAT(acc_exp[stat]);
+        }
+        average /= SS_NO_EXP_STATS;
+    }
+
+    return ({ ftime, file_size(PLAYER_FILE(name) + ".o"),
+        playerfile["login_time"],
+        (playerfile["logout_time"] ? playerfile["logout_time"] : ftime),
+        playerfile["age_heart"], query_wiz_rank(name),
+        (mappingp(playerfile["m_vars"]) ?
+            playerfile["m_vars"][SAVEVAR_RESTRICT] : 0), average });
+}
+
+/*
+ * Function name: index_player_object
+ * Description  : Update the index entry of a player from the player object
+ *                right after it was saved, so we need not read the file.
+ * Arguments    : object player - the player object.
+ */
+static void
+index_player_object(object player)
+{
+    string name = player->query_real_name();
+    int    average;
+    int    ftime;
+
+    if ((ftime = file_time(PLAYER_FILE(name) + ".o")) <= 0)
+    {
+        return;
+    }
+
+    for (int stat = 0; stat < SS_NO_EXP_STATS; stat++)
+    {
+        average += F_EXP_TO_STAT(player->query_acc_exp(stat));
+    }
+
+    m_pindex[name] = ({ ftime, file_size(PLAYER_FILE(name) + ".o"),
+        player->query_login_time(), player->query_logout_time(),
+        player->query_age(), query_wiz_rank(name),
+        player->query_restricted(), average / SS_NO_EXP_STATS });
+    player_index_changed();
+}
+
+/*
+ * Function name: remove_player_index
+ * Description  : Remove a player from the player index.
+ * Arguments    : string name - the lower case name of the player.
+ */
+static void
+remove_player_index(string name)
+{
+    if (pointerp(m_pindex[name]))
+    {
+        m_delkey(m_pindex, name);
+        player_index_changed();
+    }
+}
+
+/*
+ * Function name: query_player_index
+ * Description  : Get the index entry of a player. The playerfile is only
+ *                read when it changed since it was last indexed. The wiz
+ *                rank is always the current one.
+ * Arguments    : string name - the name of the player.
+ * Returns      : mixed - the entry, see the PIDX_ defines in std.h, or 0
+ *                    if there is no such player.
+ */
+public mixed
+query_player_index(string name)
+{
+    mixed entry;
+
+    if (!strlen(name))
+    {
+        return 0;
+    }
+
+    name = lower_case(name);
+    entry = m_pindex[name];
+
+    set_auth(this_object(), "root:root");
+    if (!pointerp(entry) ||
+        (entry[PIDX_FILE_TIME] != file_time(PLAYER_FILE(name) + ".o")))
+    {
+        if (pointerp(entry = read_player_index(name)))
+        {
+            m_pindex[name] = entry;
+        }
+        else if (pointerp(m_pindex[name]))
+        {
+            m_delkey(m_pindex, name);
+        }
+        player_index_changed();
+
+        if (!pointerp(entry))
+        {
+            return 0;
+        }
+    }
+
+    entry += ({ });
+    entry[PIDX_RANK] = query_wiz_rank(name);
+    return entry;
+}
+
 /*
  * Function name: query_find_first
  * Description  : Find out who is the first of the second.
@@ -551,6 +733,13 @@ init_player_info()
 {
     string *seconds;
 
+    m_pindex = restore_map(PLAYER_INDEX_SAVE);
+    if (!mappingp(m_pindex))
+    {
+        m_pindex = ([ ]);
+    }
+    m_pindex = filter(m_pindex, pointerp);
+
     m_seconds = restore_map(SECONDS_SAVE);
     if (!mappingp(m_seconds))
     {
@@ -726,7 +915,7 @@ public void
 purge_new_chars()
 {
     string *names = m_indices(m_newchars);
-    object player;
+    mixed  entry;
     int    age;
 
     set_auth(this_object(), "root:root");
@@ -738,9 +927,8 @@ purge_new_chars()
         {
             continue;
         }
-        player = finger_player(name);
-        age = player->query_age();
-        player->remove_object();
+        entry = query_player_index(name);
+        age = (pointerp(entry) ? entry[PIDX_AGE] : 0);
         /* Too old, wait for regular purge. */
         if (age > NEW_CHAR_MINAGE)
         {
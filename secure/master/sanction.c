@@ -279,6 +279,7 @@ create_sanction(string giver, string receiver, string type, string path)
     int    size;
 
     set_auth(this_object(), "root:root");
+    flush_access_cache();
 
     /* This is the file we are supposed to write. */
     path = SANCTION_DIR + giver + "/" + receiver +
@@ -322,6 +323,8 @@ create_sanction(string giver, string receiver, string type, string path)
  *                its contents, files or directories. If the argument is
  *                a file rather than a directory, this file will be removed
  *                as well.
+ *                Since this revokes sanctions, the kept access decisions
+ *                are forgotten.
  * Arguments    : string path - the path to remove.
  * Returns      : int 1/0 - success/failure.
  */
@@ -331,6 +334,8 @@ recursive_rmdir(string path)
     string *files;
     int    size;
 
+    flush_access_cache();
+
     switch(file_size(path))
     {
     case -2:
@@ -376,6 +381,7 @@ remove_sanction(string giver, string receiver, string type, string path)
     int    size;
 
     set_auth(this_object(), "root:root");
+    flush_access_cache();
 
     /* Construct the path to remove. */
     path = SANCTION_DIR + giver +
@@ -11,6 +11,9 @@
 #define SITEBAN_DATE    2
 #define SITEBAN_COMMENT 3
 
+/* The number of lookups timed by "siteban benchmark". */
+#define SITEBAN_BENCH_LOOKUPS 100
+
 /*
  * Global variable in the save-file:
  *
@@ -32,6 +35,22 @@ private mapping sitebans;
 private static string *sitebans_nologin;
 private static string *sitebans_nonew;
 
+/*
+ * The compiled ban list used by check_newplayer().
+ *
+ * sitebans_exact = ([ (string)ipmask : (int)type ]) masks without wildcards
+ * sitebans_tree  = a tree on the literal leading octets of the masks with
+ *                  wildcards. Each node is a mapping
+ *                  ([ (string)octet : (mapping)node,
+ *                     SITEBAN_NOLOGIN : (string *)ipmasks,
+ *                     SITEBAN_NONEW   : (string *)ipmasks ])
+ *                  where the masks are stored in the node of their literal
+ *                  prefix. Only the masks on the path of an ip number need
+ *                  to be matched against it.
+ */
+private static mapping sitebans_exact;
+private static mapping sitebans_tree;
+
 /*
  * Function name: filter_sitebans
  * Description  : Filter to find all sitebans of a particular type.
@@ -45,15 +64,153 @@ filter_sitebans(string ipmask, int type)
     return (sitebans[ipmask][SITEBAN_TYPE] == type);
 }
 
+/*
+ * Function name: wild_octet
+ * Description  : Find out whether a part of an ip mask contains wildcards.
+ * Arguments    : string octet - the part of the mask.
+ * Returns      : int 1/0 - wild or not.
+ */
+static int
+wild_octet(string octet)
+{
+    int index = -1;
+    int size = strlen(octet);
+
+    while(++index < size)
+    {
+        switch(octet[index])
+        {
+        case '*':
+        case '?':
+        case '[':
+        case '\\':
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Function name: compile_sitebans
+ * Description  : Compile a list of bans into the structures for
+ *                match_sitebans(). See sitebans_exact and sitebans_tree.
+ * Arguments    : mapping bans - ([ (string)ipmask : (int)type ])
+ * Returns      : mixed * - ({ (mapping)exact, (mapping)tree })
+ */
+static mixed *
+compile_sitebans(mapping bans)
+{
+    mapping exact = ([ ]);
+    mapping tree = ([ ]);
+    mapping node;
+    string *octets;
+    string prefix;
+    int index, octet;
+
+    foreach(string ipmask, int type: bans)
+    {
+        octets = explode(ipmask, ".");
+        index = -1;
+        while((++index < sizeof(octets)) && !wild_octet(octets[index]))
+            ;
+
+        if (index == sizeof(octets))
+        {
+            exact[ipmask] = type;
+            continue;
+        }
+
+        /* The literal octets must be exactly the start of the mask. */
+        if (index)
+        {
+            prefix = implode(octets[..(index - 1)], ".") + ".";
+            if (ipmask[..(strlen(prefix) - 1)] != prefix)
+            {
+                index = 0;
+            }
+        }
+
+        node = tree;
+        for (octet = 0; octet < index; octet++)
+        {
+            if (!mappingp(node[octets[octet]]))
+            {
+                node[octets[octet]] = ([ ]);
+            }
+            node = node[octets[octet]];
+        }
+
+        if (pointerp(node[type]))
+            node[type] += ({ ipmask });
+        else
+            node[type] = ({ ipmask });
+    }
+
+    return ({ exact, tree });
+}
+
+/*
+ * Function name: match_sitebans
+ * Description  : Match an ip number against a compiled list of bans. Only
+ *                the masks on the path of the ip number through the tree are
+ *                matched with wildmatch().
+ * Arguments    : string ipnumber - the ip number to check.
+ *                mapping exact - the masks without wildcards.
+ *                mapping tree - the tree of masks with wildcards.
+ * Returns      : int - 0, SITEBAN_NOLOGIN or SITEBAN_NONEW.
+ */
+static int
+match_sitebans(string ipnumber, mapping exact, mapping tree)
+{
+    mapping node = tree;
+    string *octets = explode(ipnumber, ".");
+    string *masks;
+    int result, mask, index = -1;
+    int size = sizeof(octets);
+
+    if ((result = exact[ipnumber]) == SITEBAN_NOLOGIN)
+        return SITEBAN_NOLOGIN;
+
+    while(mappingp(node))
+    {
+        masks = node[SITEBAN_NOLOGIN];
+        for (mask = 0; mask < sizeof(masks); mask++)
+        {
+            if (wildmatch(masks[mask], ipnumber))
+                return SITEBAN_NOLOGIN;
+        }
+
+        masks = (result ? 0 : node[SITEBAN_NONEW]);
+        for (mask = 0; mask < sizeof(masks); mask++)
+        {
+            if (wildmatch(masks[mask], ipnumber))
+            {
+                result = SITEBAN_NONEW;
+                break;
+            }
+        }
+
+        if (++index >= size)
+            break;
+        node = node[octets[index]];
+    }
+
+    return result;
+}
+
 /*
  * Function name: init_sitebans
  * Description  : Called at boot-time, and whenever the sitebans list has been
  *                updated to create separate lists of sites that have been
- *                banned nonew or nologin.
+ *                banned nonew or nologin, and to compile the list for
+ *                check_newplayer().
  */
 static void
 init_sitebans()
 {
+    mixed *compiled;
+
     if (!mappingp(sitebans))
     {
         sitebans = ([ ]);
@@ -63,6 +220,11 @@ init_sitebans()
         &filter_sitebans(, SITEBAN_NOLOGIN));
     sitebans_nonew = filter(m_indices(sitebans),
         &filter_sitebans(, SITEBAN_NONEW));
+
+    compiled = compile_sitebans(map(sitebans,
+        &operator([])(, SITEBAN_TYPE)));
+    sitebans_exact = compiled[0];
+    sitebans_tree = compiled[1];
 }
 
 /*
@@ -79,13 +241,117 @@ check_newplayer(string ipnumber)
     if (!strlen(ipnumber))
         return 0;
 
-    if (sizeof(filter(sitebans_nologin, &wildmatch(, ipnumber))))
-        return SITEBAN_NOLOGIN;
+    return match_sitebans(ipnumber, sitebans_exact, sitebans_tree);
+}
 
-    if (sizeof(filter(sitebans_nonew, &wildmatch(, ipnumber))))
-        return SITEBAN_NONEW;
+/*
+ * Function name: random_octet
+ * Description  : Make up a random octet of an ip number.
+ * Returns      : string - the octet.
+ */
+static string
+random_octet()
+{
+    return "" + random(256);
+}
 
-    return 0;
+/*
+ * Function name: benchmark_siteban
+ * Description  : Time the matching of ip numbers against a made up list of
+ *                bans, both through the compiled tree and the old way with
+ *                a wildmatch() against every mask. The real list of bans is
+ *                not touched.
+ * Arguments    : int count - the number of masks to make up.
+ * Returns      : int 1 - always.
+ */
+static int
+benchmark_siteban(int count)
+{
+    mapping bans = ([ ]);
+    string *nologin, *nonew, *ips = allocate(SITEBAN_BENCH_LOOKUPS);
+    int    *results = allocate(SITEBAN_BENCH_LOOKUPS);
+    mixed  *compiled;
+    string ipmask;
+    float  start, tree_time, linear_time;
+    int    index, type, hits, mismatches;
+
+    while(m_sizeof(bans) < count)
+    {
+        ipmask = random_octet() + "." + random_octet() + ".";
+        switch(random(4))
+        {
+        case 0:
+            ipmask += "*";
+            break;
+        case 1:
+            ipmask += random_octet() + ".*";
+            break;
+        case 2:
+            ipmask += random_octet() + "." + random(26) + "?";
+            break;
+        default:
+            ipmask += random_octet() + "." + random_octet();
+        }
+        bans[ipmask] = (random(2) ? SITEBAN_NOLOGIN : SITEBAN_NONEW);
+    }
+
+    /* Make sure some of the ip numbers are banned. */
+    index = -1;
+    while(++index < SITEBAN_BENCH_LOOKUPS)
+    {
+        ips[index] = random_octet() + "." + random_octet() + "." +
+            random_octet() + "." + random_octet();
+    }
+    foreach(string mask: m_indices(bans)[..(SITEBAN_BENCH_LOOKUPS / 4)])
+    {
+        ips[random(SITEBAN_BENCH_LOOKUPS)] =
+            implode(explode(implode(explode(mask, "*"), "1"), "?"), "2");
+    }
+
+    start = gettimeofday();
+    compiled = compile_sitebans(bans);
+    write(sprintf("Compiled %d masks in %.4f seconds.\n", count,
+        gettimeofday() - start));
+
+    start = gettimeofday();
+    index = -1;
+    while(++index < SITEBAN_BENCH_LOOKUPS)
+    {
+        results[index] = match_sitebans(ips[index], compiled[0], compiled[1]);
+    }
+    tree_time = gettimeofday() - start;
+
+    nologin = m_indices(filter(bans, &operator(==)(SITEBAN_NOLOGIN, )));
+    nonew = m_indices(bans) - nologin;
+    start = gettimeofday();
+    index = -1;
+    while(++index < SITEBAN_BENCH_LOOKUPS)
+    {
+        if (sizeof(filter(nologin, &wildmatch(, ips[index]))))
+            type = SITEBAN_NOLOGIN;
+        else if (sizeof(filter(nonew, &wildmatch(, ips[index]))))
+            type = SITEBAN_NONEW;
+        else
+            type = 0;
+
+        hits += !!type;
+        mismatches += (type != results[index]);
+    }
+    linear_time = gettimeofday() - start;
+
+    write(sprintf("%d lookups, %d banned.\n" +
+        "Tree:   %.4f seconds (%.1f usec per lookup).\n" +
+        "Linear: %.4f seconds (%.1f usec per lookup).\n",
+        SITEBAN_BENCH_LOOKUPS, hits,
+        tree_time, tree_time * 1000000.0 / itof(SITEBAN_BENCH_LOOKUPS),
+        linear_time, linear_time * 1000000.0 / itof(SITEBAN_BENCH_LOOKUPS)));
+    if (mismatches)
+    {
+        write("Mismatch! " + mismatches + " lookups differ between the " +
+            "tree and the linear search.\n");
+    }
+
+    return 1;
 }
 
 /*
@@ -275,11 +541,21 @@ siteban(string str)
         }
         return remove_siteban(words[1]);
 
+    case "benchmark":
+        if ((sizeof(words) > 2) ||
+            ((sizeof(words) == 2) && (atoi(words[1]) <= 0)))
+        {
+            notify_fail("Syntax: benchmark [<number of masks>]\n");
+            return 0;
+        }
+        return benchmark_siteban((sizeof(words) == 2) ?
+            min(atoi(words[1]), 10000) : 2000);
+
     default:
         notify_fail("No such argument to \"siteban\".\nSyntax: siteban " +
             "list nologin / nonew / <wildcards>\n        siteban [add] " +
             "nologin / nonew <ipmask> <reason>\n        siteban remove " +
-            "<ipmask>\n");
+            "<ipmask>\n        siteban benchmark [<number of masks>]\n");
         return 0;
     }
 }
@@ -0,0 +1,119 @@
+/*
+ * /secure/master/syslog.c
+ *
+ * This module buffers the busy system logs. Some logs, like the log of all
+ * combat hits, get many small lines written to them each second. Instead
+ * of appending every line to the file on its own, the lines of these logs
+ * are collected in memory and written in one go, either when enough text
+ * has been collected, or a little while after the first line came in. The
+ * cycling of the log is checked once per write, rather than once per line.
+ *
+ * The logs that are buffered are listed in LOG_BUFFERED in <log.h>.
+ */
+
+#include "/sys/log.h"
+
+/*
+ * LOG_BUFFER_SIZE  - the number of bytes after which a buffer is written.
+ * LOG_BUFFER_DELAY - the maximum delay in seconds before a buffer is written.
+ */
+#define LOG_BUFFER_SIZE  (32768)
+#define LOG_BUFFER_DELAY (10.0)
+
+#define BUF_TEXTS  0
+#define BUF_BYTES  1
+#define BUF_LENGTH 2
+
+/*
+ * Global variables. They are not saved.
+ *
+ * log_buffers - ([ string file : ({ string *texts, int bytes, int length }) ])
+ */
+static mapping log_buffers = ([ ]);
+static int     log_buffer_alarm;
+
+/*
+ * Function name: flush_syslog
+ * Description  : Write the buffered text of a single log to disk.
+ * Arguments    : string file - the log to write.
+ */
+static void
+flush_syslog(string file)
+{
+    mixed buffer = log_buffers[file];
+
+    m_delkey(log_buffers, file);
+    if (pointerp(buffer) && sizeof(buffer[BUF_TEXTS]))
+    {
+        log_file(file, implode(buffer[BUF_TEXTS], ""), buffer[BUF_LENGTH]);
+    }
+}
+
+/*
+ * Function name: flush_syslogs
+ * Description  : Write the buffered text of all logs to disk. It is called
+ *                from an alarm, and when the game shuts down.
+ */
+static void
+flush_syslogs()
+{
+    remove_alarm(log_buffer_alarm);
+    log_buffer_alarm = 0;
+
+    foreach(string file: m_indexes(log_buffers))
+    {
+        flush_syslog(file);
+    }
+}
+
+/*
+ * Function name: buffer_syslog
+ * Description  : Add a message to the buffer of a system log. The buffer
+ *                is written when it is full, or after a short delay.
+ * Arguments    : string file - the log to write into.
+ *                string text - the message to record.
+ *                int length - the cycle size of the log, see log_syslog().
+ */
+static void
+buffer_syslog(string file, string text, int length)
+{
+    mixed buffer = log_buffers[file];
+
+    if (!pointerp(buffer))
+    {
+        buffer = log_buffers[file] = ({ ({ }), 0, length });
+    }
+
+    buffer[BUF_TEXTS] += ({ text });
+    buffer[BUF_BYTES] += strlen(text);
+    buffer[BUF_LENGTH] = length;
+
+    if (buffer[BUF_BYTES] >= LOG_BUFFER_SIZE)
+    {
+        flush_syslog(file);
+        return;
+    }
+
+    if (!log_buffer_alarm)
+    {
+        log_buffer_alarm = set_alarm(LOG_BUFFER_DELAY, 0.0, flush_syslogs);
+    }
+}
+
+/*
+ * Function name: query_syslog_buffers
+ * Description  : Find out how much text is waiting to be written.
+ * Returns      : mapping - ([ string file : int bytes ])
+ */
+public mapping
+query_syslog_buffers()
+{
+    mapping result = ([ ]);
+
+    foreach(string file, mixed buffer: log_buffers)
+    {
+        result[file] = buffer[BUF_BYTES];
+    }
+
+    return result;
+}
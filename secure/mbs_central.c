@@ -52,6 +52,7 @@ static int      IndexLine,      // The current index line.
                 HelpAlarmId;    // The id-number of the alarm used.
 static string   HelpCmdName;    // The current command name.
 static mapping  BobMap;         // Board object mapping
+static mapping  NewsMap;        // Time of the last note by save path
 
 /*
  * BbpMap : ([ "save path" :
@@ -65,6 +66,8 @@ static mapping  BobMap;         // Board object mapping
  *      = list of BbpMap value lists = ])
  *
  * BrokenMap, UnusedMap : ([ "save path" : time stamp ]);
+ *
+ * NewsMap : ([ "save path" : time of the last note ])
  */
 
 /*
@@ -87,6 +90,7 @@ static mapping  BobMap;         // Board object mapping
  */
 static nomask object    find_board(string bspath);
 static nomask void      update_bbmaps();
+static nomask void      update_news(string spath);
 public nomask int       sort_dom_boards(string *item1, string *item2);
 public nomask int       sort_cath_boards(string *item1, string *item2);
 public nomask int       sort_usage_read(mixed item1, mixed item2);
@@ -512,6 +516,7 @@ remove_central_entry(string entry)
         m_delkey(BrokenMap, entry);
     if (UnusedMap[entry])
         m_delkey(UnusedMap, entry);
+    update_news(entry);
     dosave();
     write("Removed the central entry '" + entry + "'.\n");
     logit("Central entry delete [" +
@@ -647,6 +652,7 @@ list_new_boards(string dom = "")
         mail_notify(M_E_REMOVED, discard_list);
         remains = m_indexes(BbpMap) - discard;
         BbpMap = mkmapping(remains, map(remains, &operator([])(BbpMap, )));
+        map(discard, update_news);
         dosave();
         write("\n");
     }
@@ -1260,18 +1266,37 @@ query_board_desc(string bpath)
 public nomask int
 query_unread_news(string bpath, string last)
 {
-    mixed       entry;
-    int         il, ic;
+    if (!last || !NewsMap[bpath])
+        return 0;
 
-    entry = BbpMap[bpath];
+    return (atoi(last[1..]) < NewsMap[bpath]);
+}
 
-    if (!last || !entry[BBP_LNOTE])
-        return 0;
+/*
+ * Function name: query_unread_boards
+ * Description:   Find all boards with unread news in one go. This is
+ *                the same as calling query_unread_news() for each board,
+ *                but without the call overhead per board.
+ * Arguments:     marks - ([ "save path" : "last read note" ])
+ * Returns:       A mapping ([ "save path" : 1 ]) of the boards that have
+ *                news newer than the read mark.
+ */
+public nomask mapping
+query_unread_boards(mapping marks)
+{
+    mapping unread = ([]);
+    int     tm;
+
+    foreach(string spath, string last: marks)
+    {
+        if (!last || !(tm = NewsMap[spath]))
+            continue;
 
-    il = atoi(last[1..]);
-    ic = atoi(entry[BBP_LNOTE][1..]);
+        if (atoi(last[1..]) < tm)
+            unread[spath] = 1;
+    }
 
-    return (il < ic);
+    return unread;
 }
 
 /*
@@ -1695,6 +1720,7 @@ new_note(string save_path, string last_note, string room_path)
     if (room_path != BbpMap[save_path][BBP_RPATH])
         BbpMap[save_path][BBP_RPATH] = room_path;
 
+    update_news(save_path);
     dosave();
 }
 
@@ -1736,6 +1762,7 @@ remove_note(string save_path)
 
     BbpMap[save_path][BBP_LNOTE] = board->query_latest_note();
     BbpMap[save_path][BBP_PNOTE] -= 1;
+    update_news(save_path);
 
     if (!(SaveCount++ % 100))
         dosave();
@@ -1953,6 +1980,30 @@ update_bbmaps()
     entry_map = filter(BbpMap, strlen @ &operator([])(, 0));
     dmap = map(doms, &filt_bbp_data(, entry_map, BBP_DOMAIN));
     BbdMap = mkmapping(doms, dmap);
+
+    NewsMap = ([]);
+    foreach(string spath, mixed entry: BbpMap)
+    {
+        if (strlen(entry[BBP_LNOTE]))
+            NewsMap[spath] = atoi(entry[BBP_LNOTE][1..]);
+    }
+}
+
+/*
+ * Function name: update_news
+ * Description:   Update the news index after a note on a board was
+ *                posted or removed.
+ * Arguments:     spath - the save path of the board
+ */
+static nomask void
+update_news(string spath)
+{
+    mixed entry = BbpMap[spath];
+
+    if (sizeof(entry) && strlen(entry[BBP_LNOTE]))
+        NewsMap[spath] = atoi(entry[BBP_LNOTE][1..]);
+    else
+        m_delkey(NewsMap, spath);
 }
 
 /*
@@ -2272,6 +2323,7 @@ load_all_boards(string *list)
             logit("Board delete broken [Auto] " +
                 BbpMap[list[0]][BBP_BOARD] + ":" + BbpMap[list[0]][BBP_CAT]);
             m_delkey(BbpMap, list[0]);
+            update_news(list[0]);
             dosave();
         }
     }
@@ -2306,6 +2358,7 @@ load_all_boards(string *list)
                 GcTime = time();
                 logit("Board delete idle [Auto] " + BbpMap[list[0]][BBP_BOARD] + ":" + BbpMap[list[0]][BBP_CAT]);
                 m_delkey(BbpMap, list[0]);
+                update_news(list[0]);
                 dosave();
             }
         }
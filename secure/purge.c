@@ -13,6 +13,10 @@
  *
  * Some of these functions may seem a little robust and there indeed are a
  * lot of checks in this object, but then again, purging is serious business.
+ *
+ * The information about the players is taken from the player index that is
+ * kept by SECURITY, so only the playerfiles that changed since they were
+ * last indexed are read.
  */
 
 #pragma no_clone
@@ -24,7 +28,6 @@ inherit "/std/object";
 #include <formulas.h>
 #include <macros.h>
 #include <mail.h>
-#include <options.h>
 #include <std.h>
 #include <time.h>
 
@@ -69,17 +72,13 @@ private static int     purge_index;
 private static int     tested_files;
 
 /*
- * Non-static global variables.
- *
- * These global variables are a part of the playerfiles that are being
- * checked.
+ * These global variables hold the index information of the player that is
+ * being checked.
  */
-private string  name;       /* the name of the player             */
-private int     login_time; /* the last time the player logged in */
-private int     age_heart;  /* the of the player in heartbeats    */
-private int    *acc_exp;    /* the acc-experience of the player   */
-private mapping m_vars;     /* suspended or self-restricted       */
-private mapping m_seconds;  /* registered seconds of the player   */
+private static string name;       /* the name of the player             */
+private static int    login_time; /* the last time the player logged in */
+private static int    age_heart;  /* the of the player in heartbeats    */
+private static int    average;    /* the average stat of the player     */
 
 /*
  * Function name: create_object
@@ -228,9 +227,7 @@ player_age()
 static nomask int
 player_average()
 {
-    return ((F_EXP_TO_STAT(acc_exp[0]) + F_EXP_TO_STAT(acc_exp[1]) +
-             F_EXP_TO_STAT(acc_exp[2]) + F_EXP_TO_STAT(acc_exp[3]) +
-             F_EXP_TO_STAT(acc_exp[4]) + F_EXP_TO_STAT(acc_exp[5])) / 6);
+    return average;
 }
 
 /*
@@ -244,6 +241,7 @@ purge_one(string filename)
 {
     string  my_name;
     string *seconds;
+    mixed   entry;
     int     level;
     int     last_login;
     int     high_limit;
@@ -256,24 +254,21 @@ purge_one(string filename)
     /* This should be the name of the player. */
     my_name = extract(filename, 0, -3);
 
-    /* If we cannot restore it, it is not a true playerfile. */
-    if (!restore_object(PLAYER_FILE(my_name)))
-    {
-        strange_files += (filename + "\n");
-        num_strange++;
-        return;
-    }
-
-    /* Apparently not a true playerfile. The saved name does not match the
-     * filename.
+    /* If it cannot be indexed, it is not a true playerfile. Either it does
+     * not restore, or the saved name does not match the filename.
      */
-    if (name != my_name)
+    if (!pointerp(entry = SECURITY->query_player_index(my_name)))
     {
         strange_files += (filename + "\n");
         num_strange++;
         return;
     }
 
+    name = my_name;
+    login_time = entry[PIDX_LOGIN];
+    age_heart = entry[PIDX_AGE];
+    average = entry[PIDX_AVERAGE];
+
     if (!login_time)
     {
         rm(PLAYER_FILE(filename));
@@ -289,14 +284,14 @@ purge_one(string filename)
     /* Don't hurt players that are suspended by the administration or that have
      * restricted themselves.
      */
-    if (mappingp(m_vars) && m_vars[SAVEVAR_RESTRICT])
+    if (entry[PIDX_RESTRICT])
     {
         return;
     }
     junior = (extract(name, -2) == "jr");
 
     /* If the player is a wizard, report him but don't hurt him. */
-    if ((level = SECURITY->query_wiz_rank(name)) ||
+    if ((level = entry[PIDX_RANK]) ||
         (junior && (level = SECURITY->query_wiz_rank(extract(name, 0, -3)))))
     {
         if ((last_login > LOGIN_365_DAYS) && !junior)
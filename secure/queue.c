@@ -2,6 +2,17 @@
  * /secure/queue.c
  *
  * This object queues people who want to log in when the game is full.
+ *
+ * To decide whether there is room in the game, the queue keeps a registry
+ * of all interactive objects, separated into mortals and wizards. The master
+ * tells us when a connection is made, when a socket is moved to another
+ * object with exec(), when an interactive object leaves the game (quit,
+ * linkdeath or destruction) and when the rank of a wizard changes. That way
+ * the number of slots in use is known without having to look at all users.
+ *
+ * The queue itself is kept as a row of consecutive ticket numbers. Each
+ * person in the queue holds a ticket, and the position in the queue is the
+ * distance to the ticket at the head of the queue.
  */
 
 #pragma no_clone
@@ -20,15 +31,90 @@
 static void inform_queue();
 
 /*
- * The gloval variables.
+ * The global variables.
+ *
+ * slot_mortals - ([ object interactive : 1 ]) the mortals in the game.
+ * slot_wizards - ([ object interactive : int rank ]) the wizards in the game.
+ * q_tickets    - ([ int ticket : ({ object login, string name }) ]) the
+ *                people in the queue.
+ * q_objects    - ([ object login : int ticket ])
+ * q_names      - ([ string name : int ticket ])
+ * q_head       - the ticket of the first person in the queue.
+ * q_tail       - the ticket that will be handed out next.
  */
-private static object *q   = ({ });
+private static mapping slot_mortals = ([ ]);
+private static mapping slot_wizards = ([ ]);
+private static mapping q_tickets = ([ ]);
+private static mapping q_objects = ([ ]);
+private static mapping q_names = ([ ]);
+private static int     q_head;
+private static int     q_tail;
 private static string *vip = ({ });
 private static int    alarm_id;
 
+#define Q_OBJECT 0
+#define Q_NAME   1
+
 #define QUEUE_TIME              (150.0) /* 2.5 minutes */
 #define WIZARDS_PER_MORTAL_SLOT (  3  )
 
+/*
+ * Function name: add_slot
+ * Description  : Register an interactive object as user of a slot in the
+ *                game. Wizards are recognised by their rank.
+ * Arguments    : object ob - the interactive object.
+ */
+static void
+add_slot(object ob)
+{
+    int rank = SECURITY->query_wiz_rank(ob->query_real_name());
+
+    m_delkey(slot_mortals, ob);
+    m_delkey(slot_wizards, ob);
+
+    if (rank > WIZ_MORTAL)
+    {
+        slot_wizards[ob] = rank;
+    }
+    else
+    {
+        slot_mortals[ob] = 1;
+    }
+}
+
+/*
+ * Function name: remove_slot
+ * Description  : Remove an object from the registry of slot users.
+ * Arguments    : object ob - the object that no longer uses a slot.
+ */
+static void
+remove_slot(object ob)
+{
+    m_delkey(slot_mortals, ob);
+    m_delkey(slot_wizards, ob);
+}
+
+/*
+ * Function name: count_slots
+ * Description  : Build the registry of slot users from scratch. This is
+ *                done when the queue is loaded and regularly while people
+ *                are queueing, to correct for anything we may have missed.
+ */
+static void
+count_slots()
+{
+    slot_mortals = ([ ]);
+    slot_wizards = ([ ]);
+
+    foreach(object ob: users())
+    {
+        if (objectp(ob) && !q_objects[ob])
+        {
+            add_slot(ob);
+        }
+    }
+}
+
 /*
  * Function name: create
  * Description  : The people who are waiting in the queue are informed of
@@ -37,18 +123,145 @@ private static int    alarm_id;
 public void
 create()
 {
+    count_slots();
     alarm_id = set_alarm(QUEUE_TIME, QUEUE_TIME, inform_queue);
 }
 
 /*
- * Function name: short
- * Description  : Returns the short description for the queue.
- * Returns      : string - the short description.
+ * Function name: connect_slot
+ * Description  : Called from SECURITY when a new connection is made.
+ * Arguments    : object ob - the login object of the connection.
+ */
+public void
+connect_slot(object ob)
+{
+    if (previous_object() != find_object(SECURITY))
+    {
+        return;
+    }
+
+    add_slot(ob);
+}
+
+/*
+ * Function name: exec_slot
+ * Description  : Called from SECURITY when a socket is moved from one
+ *                object to another with exec(). The slot moves along.
+ * Arguments    : object to - the object that receives the socket.
+ *                object from - the object that loses the socket.
  */
-public string
-short()
+public void
+exec_slot(object to, object from)
 {
-    return "the login queue";
+    if (previous_object() != find_object(SECURITY))
+    {
+        return;
+    }
+
+    remove_slot(from);
+    add_slot(to);
+}
+
+/*
+ * Function name: update_rank
+ * Description  : Called from SECURITY when the rank of a wizard changed,
+ *                so that his or her slot is counted properly.
+ * Arguments    : string name - the name of the wizard.
+ */
+public void
+update_rank(string name)
+{
+    object ob;
+
+    if (previous_object() != find_object(SECURITY))
+    {
+        return;
+    }
+
+    if (objectp(ob = find_player(name)) &&
+        (slot_mortals[ob] || slot_wizards[ob]))
+    {
+        add_slot(ob);
+    }
+}
+
+/*
+ * Function name: queue_objects
+ * Description  : Get the people in the queue in the order of the queue.
+ * Returns      : object * - the objects in the queue.
+ */
+static object *
+queue_objects()
+{
+    object *list = allocate(q_tail - q_head);
+    int    index = -1;
+    int    size = sizeof(list);
+
+    while(++index < size)
+    {
+        list[index] = q_tickets[q_head + index][Q_OBJECT];
+    }
+
+    return list;
+}
+
+/*
+ * Function name: queue_remove
+ * Description  : Take someone out of the queue. When it is the first person
+ *                in the queue, this is a matter of moving the head. When it
+ *                is someone further down, the people behind move up one
+ *                ticket, so that the tickets remain consecutive.
+ * Arguments    : int ticket - the ticket of the person to remove.
+ * Returns      : object - the object that held the ticket.
+ */
+static object
+queue_remove(int ticket)
+{
+    mixed entry = q_tickets[ticket];
+
+    if (!pointerp(entry))
+    {
+        return 0;
+    }
+
+    m_delkey(q_objects, entry[Q_OBJECT]);
+    m_delkey(q_objects, 0);
+    m_delkey(q_names, entry[Q_NAME]);
+
+    if (ticket == q_head)
+    {
+        m_delkey(q_tickets, q_head++);
+        return entry[Q_OBJECT];
+    }
+
+    while(++ticket < q_tail)
+    {
+        q_tickets[ticket - 1] = q_tickets[ticket];
+        q_objects[q_tickets[ticket][Q_OBJECT]] = ticket - 1;
+        q_names[q_tickets[ticket][Q_NAME]] = ticket - 1;
+    }
+    m_delkey(q_tickets, --q_tail);
+
+    return entry[Q_OBJECT];
+}
+
+/*
+ * Function name: queue_pop
+ * Description  : Take the first person out of the queue. He or she will
+ *                enter the game and is therefore registered as slot user.
+ * Returns      : object - the first person in the queue.
+ */
+static object
+queue_pop()
+{
+    object ob = queue_remove(q_head);
+
+    if (objectp(ob))
+    {
+        add_slot(ob);
+    }
+
+    return ob;
 }
 
 /*
@@ -60,8 +273,18 @@ short()
 static void
 validate_queue()
 {
-    q = filter(q, objectp);
-    q = filter(q, interactive);
+    object ob;
+    int    ticket = q_tail;
+
+    /* Walk from the tail, so the tickets still to check do not move. */
+    while(--ticket >= q_head)
+    {
+        ob = q_tickets[ticket][Q_OBJECT];
+        if (!objectp(ob) || !interactive(ob))
+        {
+            queue_remove(ticket);
+        }
+    }
 }
 
 /*
@@ -77,15 +300,13 @@ validate_queue()
 public mixed
 queue_list(int arg)
 {
-    validate_queue();
-
     if (!arg)
     {
-	return secure_var(q);
+	return queue_objects();
     }
     else
     {
-	return q->query_pl_name();
+	return queue_objects()->query_pl_name();
     }
 }
 
@@ -102,14 +323,16 @@ queue_list(int arg)
 static int
 slots_free()
 {
-    object *list;
-    int    wizards;
+    int mortals = m_sizeof(slot_mortals);
+    int wizards = m_sizeof(slot_wizards);
 
-    list = users() - ({ previous_object() }) - q;
-    list = filter(list, objectp);
-    wizards = sizeof(filter(list, &->query_wiz_level()));
+    /* The person asking does not take a slot yet. */
+    if (slot_mortals[previous_object()])
+    {
+        mortals--;
+    }
 
-    return (MAX_PLAY - ((sizeof(list) - wizards) +
+    return (MAX_PLAY - (mortals +
 	((wizards + WIZARDS_PER_MORTAL_SLOT - 1) / WIZARDS_PER_MORTAL_SLOT)));
 }
 
@@ -152,12 +375,10 @@ force_quit_idler(object player)
 public int
 should_queue(string name)
 {
-    object *list;
-
     /* If not called from the login object, return the queue size. */
     if (MASTER_OB(previous_object()) != LOGIN_OBJECT)
     {
-	return sizeof(q) + 1;
+	return (q_tail - q_head) + 1;
     }
 
     /* Wizards above 'normal' level always enter the game without problems.
@@ -179,37 +400,38 @@ should_queue(string name)
     }
    
     /* Begin by getting rid of idlers. This is done EVERY time anyone
-     * tries to log in. Some can be idle longer than others.
+     * tries to log in. Some can be idle longer than others. The rank of
+     * the wizards is known from the registry of slots.
      */
-    validate_queue();
-    list = users() - ({ previous_object() }) - q;
-    list = filter(list, objectp);
-    list = filter(list, interactive);
-
-    foreach(object player: list)
-    {
-#ifdef NO_WIZARD_IDLE_CHECK
-        if (!SECURITY->query_wiz_rank(player->query_real_name()) &&
-            query_idle(player) > MAX_IDLE_TIME)
-#else
-	if (query_idle(player) > (MAX_IDLE_TIME * (1 +
-	    SECURITY->query_wiz_rank(player->query_real_name()))))
-#endif NO_WIZARD_IDLE_CHECK
+    foreach(object player: m_indexes(slot_mortals))
+    {
+	if (objectp(player) && (player != previous_object()) &&
+	    interactive(player) && (query_idle(player) > MAX_IDLE_TIME))
 	{
             set_alarm(0.0, 0.0, &force_quit_idler(player));
 	}
     }
+#ifndef NO_WIZARD_IDLE_CHECK
+    foreach(object player, int rank: slot_wizards)
+    {
+	if (objectp(player) && interactive(player) &&
+	    (query_idle(player) > (MAX_IDLE_TIME * (1 + rank))))
+	{
+            set_alarm(0.0, 0.0, &force_quit_idler(player));
+	}
+    }
+#endif NO_WIZARD_IDLE_CHECK
 
     /* People are already queueing, so you cannot enter. Take a number. */
-    if (sizeof(q))
+    if (q_tail > q_head)
     {
-	return sizeof(q) + 1;
+	return (q_tail - q_head) + 1;
     }
 
     /* There are no slots free for mortals, so start a queue. */
     if (slots_free() < 1)
     {
-	return sizeof(q) + 1;
+	return 1;
     }
 
     /* We passed all tests, so we can enter. */
@@ -226,37 +448,57 @@ should_queue(string name)
 public int
 enqueue(object ob)
 {
-    int pos;
+    string name;
+    object old;
+    int    ticket;
 
     /* Should only be called from the login object. */
     if (MASTER_OB(ob) != LOGIN_OBJECT)
     {
-	return sizeof(q);
+	return (q_tail - q_head);
     }
 
+    /* Someone in the queue does not use a slot. */
+    remove_slot(ob);
+
     /* If the player is already in the queue, we insert the new object in
      * the queue at the position of the other object, so actually we are
      * very nice ;-)
      */
-    if ((pos = member_array(ob->query_pl_name(), queue_list(1))) != -1)
+    name = ob->query_pl_name();
+    if (ticket = q_names[name])
     {
-	q[pos]->catch_tell("You entered the queue again, so this copy is " +
-	    "removed.\n");
-	q[pos]->remove_object();
-	q[pos] = ob;
+	old = q_tickets[ticket][Q_OBJECT];
+	q_tickets[ticket] = ({ ob, name });
+	m_delkey(q_objects, old);
+	q_objects[ob] = ticket;
 
-	return (pos + 1);
+	if (objectp(old))
+	{
+	    old->catch_tell("You entered the queue again, so this copy is " +
+		"removed.\n");
+	    old->remove_object();
+	}
+
+	return (ticket - q_head + 1);
     }
 
-    validate_queue();
-    q = q + ({ ob });
+    /* Tickets start at 1, so that 0 means 'not in the queue'. */
+    if (q_tail == q_head)
+    {
+	q_head = q_tail = 1;
+    }
+
+    q_tickets[q_tail] = ({ ob, name });
+    q_objects[ob] = q_tail;
+    q_names[name] = q_tail++;
 
     if (!alarm_id)
     {
         alarm_id = set_alarm(QUEUE_TIME, QUEUE_TIME, inform_queue);
     }
 
-    return sizeof(q);
+    return (q_tail - q_head);
 }
 
 /*
@@ -270,39 +512,56 @@ enqueue(object ob)
 public void
 dequeue(object ob)
 {
-    int size;
     int index;
     int free;
 
-    validate_queue();
-    
     /* If a player leaves the queue, we won't update the information of the
      * players in the queue to let them advance. No space was created in the
      * game, so no player can really enter anyway. However, we kick the
      * object out of the queue.
      */
-    if (member_array(ob, q) != -1)
+    if (q_objects[ob])
     {
-	q -= ({ ob });
+	queue_remove(q_objects[ob]);
 
 	return;
     }
 
+    /* Objects that did not use a slot do not make room in the game. */
+    if (!slot_mortals[ob] && !slot_wizards[ob])
+    {
+	return;
+    }
+    remove_slot(ob);
+
     /* See how many slots are free now, and make the players in the queue
      * advance as far as possible. Other players will have their queue
      * status updated.
      */
+    if (q_tail == q_head)
+    {
+	return;
+    }
+
     free = slots_free();
     if (free > 0)
     {
-	index = -1;
-	size = sizeof(q);
-	while(++index < size)
+	while((index < free) && (q_tail > q_head))
+	{
+	    index++;
+	    if (objectp(ob = queue_pop()))
+	    {
+		ob->advance(0);
+	    }
+	}
+
+	foreach(object waiting: queue_objects())
 	{
-	    q[index]->advance((index < free) ? 0 : (index - free + 1));
+	    if (objectp(waiting))
+	    {
+		waiting->advance(q_objects[waiting] - q_head + 1);
+	    }
 	}
-	
-	q = ((size > free) ? q[free..] : ({ }) );
     }
 
     /* Re-start the alarm to give the next update in QUEUE_TIME seconds. */
@@ -319,23 +578,21 @@ dequeue(object ob)
 static void
 inform_queue()
 {
-    int index;
-    int size;
-
     validate_queue();
 
-    if (!sizeof(q))
+    if (q_tail == q_head)
     {
         remove_alarm(alarm_id);
         alarm_id = 0;
         return;
     }
 
-    index = -1;
-    size = sizeof(q);
-    while(++index < size)
+    /* While people are waiting, make sure we count the slots right. */
+    count_slots();
+
+    foreach(object ob: queue_objects())
     {
-	q[index]->advance(index + 1);
+	ob->advance(q_objects[ob] - q_head + 1);
     }
 }
 
@@ -347,9 +604,7 @@ inform_queue()
 public int
 query_queue()
 {
-    validate_queue();
-
-    return sizeof(q);
+    return (q_tail - q_head);
 }
 
 /*
@@ -363,7 +618,21 @@ query_queue()
 public int
 query_position(string name)
 {
-    return member_array(name, queue_list(1));
+    int ticket = q_names[name];
+
+    return (ticket ? (ticket - q_head) : -1);
+}
+
+/*
+ * Function name: query_slots
+ * Description  : Find out how many mortals and wizards use a slot in the
+ *                game, not counting the people in the queue.
+ * Returns      : int * - ({ mortals, wizards })
+ */
+public int *
+query_slots()
+{
+    return ({ m_sizeof(slot_mortals), m_sizeof(slot_wizards) });
 }
 
 /*
@@ -376,7 +645,7 @@ query_position(string name)
 public int
 set_vip(string v)
 {
-    int pos;
+    object ob;
 
     /* May only be called from the arch-soul. */
     if (!CALL_BY(WIZ_CMD_ARCH))
@@ -391,14 +660,16 @@ set_vip(string v)
     }
 
     /* Player is already in the queue, making him leave it. */
-    if ((pos = member_array(v, queue_list(1))) != -1)
+    if (q_names[v])
     {
-	q[pos]->catch_tell("You have been given VIP access to leave the " +
+	ob = queue_remove(q_names[v]);
+	add_slot(ob);
+
+	ob->catch_tell("You have been given VIP access to leave the " +
 	    "queue by " + capitalize(this_player()->query_real_name()) +
 	    ".\n");
-	set_this_player(q[pos]);
-	q[pos]->advance(0);
-	q[pos] = 0;
+	set_this_player(ob);
+	ob->advance(0);
 
 	return 1;
     }    
@@ -454,7 +725,7 @@ tell_queue(string str)
 {
     validate_queue();
 
-    q->catch_tell(str);
+    queue_objects()->catch_tell(str);
 }
 
 /*
@@ -467,7 +738,7 @@ remove_object()
 {
     tell_queue("The queue is being destructed.\n" +
 	"Please connect another time.\n");
-    q->remove_object();
+    queue_objects()->remove_object();
 
     destruct();
 }
@@ -55,6 +55,10 @@
  * date    ( 9) 69..77 ("dd mmm yy" e.g. "30 Jun 12")
  *
  * During display, the rank length is abbreviated to 7 characters.
+ *
+ * The headers of all notes are also kept in the file index.o in the board
+ * directory. It is read when the board loads. The note files themselves are
+ * only read when a note is read.
  */
 
 #pragma save_binary
@@ -85,6 +89,14 @@ inherit "/std/object";
 #define READ_STAT	   0
 #define WRITE_STAT	   1
 
+/*
+ * The headers of all notes are kept in an index file in the board directory,
+ * so the board does not have to read every note when it loads. The name
+ * must not start with a "b", like the notes do.
+ */
+#define BOARD_INDEX	   "index"
+#define INDEX_HEADERS	   "headers"
+
 /*
  * Global variables. They are not savable, the first two are private too,
  * which means that people cannot dump them.
@@ -114,6 +126,7 @@ public nomask  int remove_msg(string what_msg);
 public nomask  int rename_msg(string str);
 public nomask  int store_msg(string str);
 nomask private string *extract_headers(int number);
+private nomask void save_index();
 
 /*
  * Function name: set_num_notes
@@ -439,11 +452,17 @@ check_remove(int note = 0)
  *                the board by cloning it and then calling the set-functions
  *                externally. This function also sets the fuse that makes
  *                it impossible to alter the board-specific properties.
+ *                The headers are taken from the index file. Only notes that
+ *                are not in the index are read, after which the index is
+ *                saved again.
  */
 private nomask void
 load_headers()
 {
     string *notes;
+    mapping index = ([ ]);
+    mixed  header;
+    int    changed;
 
     /* Set the fuse to make it impossible to alter any of the board-specific
      * properties.
@@ -452,15 +471,59 @@ load_headers()
 
     seteuid(getuid());
 
-    notes = get_dir(board_name + "/b*");
-    msg_num = sizeof(notes);
-    if (msg_num)
+    if (file_size(board_name + "/" + BOARD_INDEX + ".o") > 0)
     {
-        headers = map(sort_array(
-            map(notes, &atoi() @ &extract(, 1))), extract_headers);
+        catch(index = restore_map(board_name + "/" + BOARD_INDEX));
+        if (!mappingp(index) ||
+            !pointerp(index[INDEX_HEADERS]))
+        {
+            index = ([ INDEX_HEADERS : ({ }) ]);
+        }
+
+        /* From ({ ({ header, note }) }) to ([ note : header ]). */
+        index = mkmapping(map(index[INDEX_HEADERS], &operator([])(, 1)),
+            map(index[INDEX_HEADERS], &operator([])(, 0)));
     }
-    else
-        headers = ({ });
+
+    headers = ({ });
+    if (!pointerp(notes = get_dir(board_name + "/b*")))
+        notes = ({ });
+    foreach(int number: sort_array(map(notes, &atoi() @ &extract(, 1))))
+    {
+        if (stringp(index["b" + number]))
+        {
+            headers += ({ ({ index["b" + number], "b" + number }) });
+        }
+        else if (pointerp(header = extract_headers(number)))
+        {
+            headers += ({ header });
+            changed = 1;
+        }
+    }
+    msg_num = sizeof(headers);
+
+    /* Notes were added or removed behind our back. */
+    if (changed ||
+        (m_sizeof(index) != msg_num))
+    {
+        save_index();
+    }
+}
+
+/*
+ * Function name: save_index
+ * Description  : Save the headers of the notes to the index file.
+ */
+private nomask void
+save_index()
+{
+    seteuid(getuid());
+
+    /* If the directory doesn't exist, there are no notes to index. */
+    if (file_size(board_name) != -2)
+        return;
+
+    save_map(([ INDEX_HEADERS : headers ]), board_name + "/" + BOARD_INDEX);
 }
 
 /*
@@ -924,6 +987,7 @@ post_note(string head, string message)
     write_file(board_name + "/" + fname, head + "\n" + message);
     headers += ({ ({ abbreviate_rank(head), fname }) });
     msg_num++;
+    save_index();
 
     /* Update the master board central unless that has been prohibited. */
     if (!no_report)
@@ -1202,6 +1266,7 @@ remove_msg(string what_msg)
 
     headers = exclude_array(headers, note, note);
     msg_num--;
+    save_index();
 
     if ((note == msg_num) &&
 	(!no_report))
@@ -1295,6 +1360,7 @@ rename_msg(string str)
 	read_file(board_name + "/" + headers[num][1], 2);
     rm(board_name + "/" + headers[num][1]);
     write_file(board_name + "/" + headers[num][1], note);
+    save_index();
 
     write("Author on note " + (++num) + " changed from " +
 	capitalize(this_player()->query_real_name()) + " to " +
@@ -39,6 +39,7 @@
  */
 
 static void update_modified_pen();
+static void update_attack_table();
 public nomask int cb_query_panic();
 static nomask int fixnorm(int offence, int defence);
 static nomask void heart_beat();
@@ -84,7 +85,7 @@ static int    *att_id = ({}),    /* Id's for attacks */
               panic_time,        /* Time panic last checked. */
               tohit_val,         /* A precalculated tohit value for someone */
               i_am_real,         /* True if the living object is interactive */
-              alarm_id,          /* The id of the heart_beat alarm */
+              heart_running,     /* True if we are scheduled on the clock */
               combat_time,       /* The last time a hit was made. */
               tohit_mod,         /* Bonus/Minus to the tohit value */
               acro_evade;        /* Evade value due to SS_ACROBAT */
@@ -101,6 +102,13 @@ static object me,                /* The living object concerned */
 
 static mapping dam_by_dt = ([ ]); /* ([ int dt : int cumulative damage ]) */
 
+static int    *attack_procu,     /* Cached %use of each attack, 0 if stale */
+              attack_total;      /* Cached sum of the %use of all attacks */
+
+static mixed  *round_watchers;   /* The onlookers during a round, see
+                                    query_watchers() */
+static object round_env;         /* Where the onlookers were found */
+
 static string *cb_did_hit_acrobatic_miss_actions = ({
         "backflip",
         "groundroll",
@@ -513,6 +521,7 @@ cb_configure()
     hit_id = ({});
     hitloc_ac = ({});
     attacks = ({});
+    attack_procu = 0;
 }
 
 static void
@@ -901,6 +910,68 @@ cb_hitloc_desc(int hid)
     return hitloc_ac[i][HIT_DESC];
 }
 
+/*
+ * Function name: query_watchers
+ * Description:   Find the onlookers of our fight. The room keeps track of
+ *                who wants to see fights, so we only have to find out who
+ *                can see. During a combat round this is done only once and
+ *                the same onlookers get all messages of the round.
+ * Returns:       mixed * - ({ object *see, object *blind, object *miss })
+ *                    see   - those who see us fight.
+ *                    blind - those who see the fight, but not us.
+ *                    miss  - those who see us and want to see misses.
+ */
+static mixed *
+query_watchers()
+{
+    object env, *see, *blind, *miss;
+    mixed audience;
+
+    if (round_watchers && objectp(me) && (environment(me) == round_env))
+    {
+        return round_watchers;
+    }
+
+    see = ({ });
+    blind = ({ });
+    miss = ({ });
+    if (!objectp(me) || !objectp(env = environment(me)))
+    {
+        return ({ see, blind, miss });
+    }
+
+    if (!pointerp(audience = env->query_fight_audience()))
+    {
+        /* Not a room, so find the audience ourselves, the way the room
+         * would.
+         */
+        audience = ({ ({ }), ({ }) });
+        foreach(object ob: all_inventory(env))
+        {
+            if (function_exists("catch_msg", ob) &&
+                !ob->query_option(OPT_NO_FIGHTS))
+            {
+                audience[0] += ({ ob });
+                if (!ob->query_option(OPT_GAG_MISSES))
+                    audience[1] += ({ ob });
+            }
+        }
+    }
+
+    foreach(object ob: audience[0] - ({ me }))
+    {
+        if (CAN_SEE_IN_ROOM(ob))
+        {
+            if (CAN_SEE(ob, me))
+                see += ({ ob });
+            else
+                blind += ({ ob });
+        }
+    }
+
+    return ({ see, blind, see & audience[1] });
+}
+
 /*
  * Function name: tell_watcher
  * Description:   Send the string from the fight to people that want them
@@ -911,33 +982,29 @@ cb_hitloc_desc(int hid)
 varargs void
 tell_watcher(string str, mixed enemy, mixed arr)
 {
-    object *objs;
+    object *objs, *blind;
+    mixed watchers = query_watchers();
 
-    objs = all_inventory(environment(me)) - ({ me });
-    if (arr)
+    if (!pointerp(enemy))
     {
-        if (pointerp(arr))
-            objs -= arr;
-        else
-            objs -= ({ arr });
+        enemy = ({ enemy });
     }
 
-    if (!pointerp(enemy))
+    objs = watchers[0] - enemy;
+    blind = watchers[1] - enemy;
+    if (arr)
     {
-        enemy = ({ enemy });
+        if (!pointerp(arr))
+            arr = ({ arr });
+        objs -= arr;
+        blind -= arr;
     }
 
-    objs -= enemy;
-    foreach(object ob: objs)
+    objs->catch_msg(str);
+    foreach(object ob: blind)
     {
-        if (!ob->query_option(OPT_NO_FIGHTS) && CAN_SEE_IN_ROOM(ob))
-        {
-            if (CAN_SEE(ob, me))
-                ob->catch_msg(str);
-            else
-            tell_object(ob, capitalize(FO_COMPOSITE_ALL_LIVE(enemy, ob)) +
-                (sizeof(enemy) == 1 ? " is " : " are ") + "hit by someone.\n");
-        }
+        tell_object(ob, capitalize(FO_COMPOSITE_ALL_LIVE(enemy, ob)) +
+            (sizeof(enemy) == 1 ? " is " : " are ") + "hit by someone.\n");
     }
 }
 
@@ -954,7 +1021,7 @@ tell_watcher_miss(string str, object enemy, mixed arr)
 {
     object *objs;
 
-    objs = all_inventory(environment(me)) - ({ me, enemy });
+    objs = query_watchers()[2] - ({ enemy });
     if (arr)
     {
         if (pointerp(arr))
@@ -963,16 +1030,7 @@ tell_watcher_miss(string str, object enemy, mixed arr)
             objs -= ({ arr });
     }
 
-    foreach(object ob: objs)
-    {
-        if (!ob->query_option(OPT_NO_FIGHTS) &&
-            !ob->query_option(OPT_GAG_MISSES) &&
-            CAN_SEE_IN_ROOM(ob) &&
-            CAN_SEE(ob, me))
-        {
-            ob->catch_msg(str);
-        }
-    }
+    objs->catch_msg(str);
 }
 
 /*
@@ -1707,20 +1765,18 @@ cb_query_speed()
 
 /*
  * Function name: cb_update_speed
- * Description:   Makes sure the correct speed is used.
+ * Description:   Makes sure the correct speed is used. If we are fighting,
+ *                the next round is moved on the combat clock.
  */
 public nomask void
 cb_update_speed()
 {
-    mixed alarm;
     float oldspeed = speed;
 
     cb_calc_speed();
-    if ((speed != oldspeed) && alarm_id && (alarm = get_alarm(alarm_id)))
+    if ((speed != oldspeed) && heart_running)
     {
-        float next = speed * (alarm[2] / alarm[3]);
-        remove_alarm(alarm_id);
-        alarm_id = set_alarm(next, speed, heart_beat);
+        COMBAT_CLOCK->reschedule(speed);
     }
 }
 
@@ -1734,30 +1790,85 @@ restart_heart()
     /* Mark this moment as being in combat. */
     cb_update_combat_time();
 
-    if (!alarm_id || !get_alarm(alarm_id))
+    if (!heart_running || !COMBAT_CLOCK->query_scheduled(this_object()))
     {
         cb_update_speed();
-        alarm_id = set_alarm(speed, speed, heart_beat);
+        COMBAT_CLOCK->schedule(speed);
+        heart_running = 1;
     }
 }
 
 /*
  * Function name: stop_heart
- * Description  : Called to stop the heartbeat. It will remove the running
- *                alarm.
+ * Description  : Called to stop the heartbeat. It will take us off the
+ *                combat clock.
  */
 static void
 stop_heart()
 {
     me->remove_prop(LIVE_I_ATTACK_DELAY);
-    remove_alarm(alarm_id);
-    alarm_id = 0;
+    if (heart_running)
+    {
+        COMBAT_CLOCK->unschedule();
+        heart_running = 0;
+    }
 
     /* Garbage collection. */
     if (!objectp(me))
         remove_object();
 }
 
+/*
+ * Function name: cb_clock_round
+ * Description  : Called from the combat clock when our next round is due.
+ *                Only the clock may call this.
+ */
+public nomask void
+cb_clock_round()
+{
+    if (previous_object() != find_object(COMBAT_CLOCK))
+    {
+        return;
+    }
+
+    heart_beat();
+}
+
+/*
+ * Function name: cb_clock_resume
+ * Description  : Called from our own alarm to register with the new combat
+ *                clock when our next round is due, and run that round.
+ */
+static void
+cb_clock_resume()
+{
+    if (!heart_running || COMBAT_CLOCK->query_scheduled(this_object()))
+    {
+        return;
+    }
+
+    COMBAT_CLOCK->schedule(speed);
+    heart_beat();
+}
+
+/*
+ * Function name: cb_clock_removed
+ * Description  : Called from the combat clock when it is destructed, so
+ *                that we can register with the new clock. Only the clock
+ *                may call this.
+ * Arguments    : float left - the time until our next round was due.
+ */
+public nomask void
+cb_clock_removed(float left)
+{
+    if (previous_object() != find_object(COMBAT_CLOCK))
+    {
+        return;
+    }
+
+    set_alarm(left, 0.0, cb_clock_resume);
+}
+
 /*
  * Function name: heart_beat
  * Description:   Do 1 round of fighting with the choosen enemy. This is
@@ -1772,6 +1883,11 @@ heart_beat()
     mixed           *hitresult, *dbits, pen, fail;
     object          *new, ob;
 
+    /* The onlookers of the last round may be left if it ended in an error.
+     * They must not be used by the hooks before this round's are found.
+     */
+    round_watchers = 0;
+
     if (!objectp(me) || me->query_ghost())
     {
         attack_ob = 0;
@@ -1858,19 +1974,29 @@ heart_beat()
     /* Mark this moment as being in combat. */
     cb_update_combat_time();
 
-    il = -1;
-    size = sizeof(attacks);
-    int total_attackproc = 0;
-
-    while(++il < size)
+    if (!attack_procu)
     {
-        total_attackproc += attacks[il][ATT_PROCU];
+        update_attack_table();
     }
+
+    /* All messages of this round go to the same onlookers. */
+    round_watchers = query_watchers();
+    round_env = environment(me);
+
+    int *procu = attack_procu;
+    int total_attackproc = attack_total;
     int num_attacks = total_attackproc / 100;
     if (random(100) < total_attackproc % 100)
         num_attacks++;
 
-    int* used_attacks = ({ });
+    /* The ids of the attacks that have been used this round. The
+     * attacks may be added or removed during the round, which moves
+     * them in the table, so they are kept by id.
+     */
+    mapping used_attacks = ([ ]);
+    int id;
+    mixed attack;
+    size = sizeof(procu);
 
     while (num_attacks > 0 && total_attackproc > 0)
     {
@@ -1880,150 +2006,180 @@ heart_beat()
             break;
         }
 
+        /*
+         * An attack may have been changed by the previous attack, for
+         * instance when a weapon got dull. Continue with the new odds.
+         */
+        if (procu != attack_procu)
+        {
+            update_attack_table();
+            procu = attack_procu;
+            size = sizeof(procu);
+            total_attackproc = 0;
+            il = -1;
+            while (++il < size)
+            {
+                if (!used_attacks[att_id[il]])
+                {
+                    total_attackproc += procu[il];
+                }
+            }
+
+            if (total_attackproc <= 0)
+            {
+                break;
+            }
+        }
+
         // Pick a spot out of all the remaining attackproc.
         int selected = random(total_attackproc);
 
         il = -1;
-        while(++il < size && selected > 0)
+        while (++il < size)
         {
-
-            if (member_array(il, used_attacks) != -1)
+            if (used_attacks[att_id[il]])
             {
                 // This was already deducted from total_attackproc
                 continue;
             }
 
-            selected -= attacks[il][ATT_PROCU];
-
             // Is this the block of total_attackproc we wanted?
-            if (selected < 0)
+            if ((selected -= procu[il]) < 0)
             {
-                /*
-                 * Reduce the total available attacks, the total odds,
-                 * and mark this attack as being used up.
-                 */
-                total_attackproc -= attacks[il][ATT_PROCU];
-                num_attacks--;
-                used_attacks += ({ il });
-
-                /*
-                 * The attack has a chance of failing. If for example the attack
-                 * comes from a wielded weapon, the weapon can force a fail or
-                 * if the wchit is to low for this opponent.
-                 */
-                hitsuc = cb_try_hit(att_id[il]);
-                if (hitsuc <= 0)
-                {
-                    // This attack id failed, but others may pass.
-                    break;
-                }
+                break;
+            }
+        }
 
-                /*
-                 * The intended victim can also force a fail. like in the weapon
-                 * case, if fail, the cause must produce explanatory text himself.
-                 */
-                hitsuc = attack_ob->query_not_attack_me(me, att_id[il]);
-                if (hitsuc > 0)
-                {
-                    // This attack id was prevented, but others may pass.
-                    break;
-                }
+        if (il >= size)
+        {
+            break;
+        }
 
-                if (!objectp(attack_ob))
-                {
-                    // The attack object has vanished, no more attacks this round.
-                    num_attacks = 0;
-                    break;
-                }
+        /*
+         * Reduce the total available attacks, the total odds,
+         * and mark this attack as being used up.
+         */
+        total_attackproc -= procu[il];
+        num_attacks--;
+        id = att_id[il];
+        attack = attacks[il];
+        used_attacks[id] = 1;
+
+        /*
+         * The attack has a chance of failing. If for example the attack
+         * comes from a wielded weapon, the weapon can force a fail or
+         * if the wchit is to low for this opponent.
+         */
+        hitsuc = cb_try_hit(id);
+        if (hitsuc <= 0)
+        {
+            // This attack id failed, but others may pass.
+            continue;
+        }
 
-                hitsuc = cb_tohit(att_id[il], attacks[il][ATT_WCHIT], attack_ob);
+        /*
+         * The intended victim can also force a fail. like in the weapon
+         * case, if fail, the cause must produce explanatory text himself.
+         */
+        hitsuc = attack_ob->query_not_attack_me(me, id);
+        if (hitsuc > 0)
+        {
+            // This attack id was prevented, but others may pass.
+            continue;
+        }
 
-                if (hitsuc > 0)
-                {
-                    /* Choose one damage type */
-                    dt = attacks[il][ATT_DAMT];
-                    dbits = ({ dt & W_IMPALE, dt & W_SLASH, dt & W_BLUDGEON }) - ({ 0 });
-                    dt = sizeof(dbits) ? one_of_list(dbits) : W_BLUDGEON;
-
-                    mixed pen = attacks[il][ATT_M_PEN];
-
-                    /* Get the base pen */
-                    if (sizeof(pen))
-                    {
-                        tmp = MATH_FILE->quick_find_exp(dt);
-                        if (tmp < sizeof(pen))
-                            pen = pen[tmp];
-                        else
-                            pen = pen[0];
-                    }
-
-                    if (crit = (!random(crit_freq)))
-                    {
-                        pen = F_CRIT_MOD(pen);
-                    }
-
-                    hitresult = attack_ob->hit_me(pen, dt, me, att_id[il]);
-
-                    if (crit)
-                    {
-                        SECURITY->log_syslog("CRITICAL", sprintf("%s: %-11s on %-11s " +
-                            "(crit pen = %d; hp - dam = %d - %d%s), freq %d\n\t%s on %s\n",
-                            ctime(time()),  capitalize(me->query_real_name()),
-                            capitalize(attack_ob->query_real_name()), pen,
-                            attack_ob->query_hp(), hitresult[3],
-                            ((attack_ob->query_hp() <= hitresult[3]) ? " LETHAL" : ""),
-                            crit_freq, file_name(me), file_name(attack_ob)), LOG_SIZE_100K);
-                    }
-                }
-                else
-                {
-                    hitresult = attack_ob->hit_me(hitsuc, 0, me, att_id[il]);
-                }
+        if (!objectp(attack_ob))
+        {
+            // The attack object has vanished, no more attacks this round.
+            break;
+        }
 
-                /*
-                 * Generate combat message, arguments Attack id, hitloc description
-                 * proc_hurt, Defender
-                 */
-                if (hitsuc > 0)
-                {
-                    hitsuc = attacks[il][ATT_WCPEN][tmp];
-                    if (hitsuc > 0)
-                    {
-                        hitsuc = 100 * hitresult[2] / hitsuc;
-                    }
-                    else
-                    {
-                        hitsuc = 0;
-                    }
-                }
-                if (hitresult[1])
-                {
-                    cb_did_hit(att_id[il], hitresult[1], hitresult[4], hitresult[0],
-                           attack_ob, dt, hitsuc, hitresult[3]);
-                    if (crit)
-                    {
-                          cb_did_crit(att_id[il], hitresult[1], hitresult[4],
-                              hitresult[0], attack_ob, dt, hitsuc, hitresult[3]);
-                    }
-                }
+        hitsuc = cb_tohit(id, attack[ATT_WCHIT], attack_ob);
+
+        if (hitsuc > 0)
+        {
+            /* Choose one damage type */
+            dt = attack[ATT_DAMT];
+            dbits = ({ dt & W_IMPALE, dt & W_SLASH, dt & W_BLUDGEON }) - ({ 0 });
+            dt = sizeof(dbits) ? one_of_list(dbits) : W_BLUDGEON;
+
+            mixed pen = attack[ATT_M_PEN];
+
+            /* Get the base pen */
+            if (sizeof(pen))
+            {
+                tmp = MATH_FILE->quick_find_exp(dt);
+                if (tmp < sizeof(pen))
+                    pen = pen[tmp];
                 else
-                {
-                    num_attacks = 0;
-                    break; /* Ghost, linkdeath, immortals etc */
-                }
+                    pen = pen[0];
+            }
 
-                /* Oops, Lifeform turned into a deadform. Reward the killer. */
-                if (attack_ob->query_hp() <= 0)
-                {
-                    enemies = enemies - ({ attack_ob });
-                    attack_ob->do_die(me);
-                    num_attacks = 0;
-                    break;
-                }
+            if (crit = (!random(crit_freq)))
+            {
+                pen = F_CRIT_MOD(pen);
+            }
+
+            hitresult = attack_ob->hit_me(pen, dt, me, id);
+
+            if (crit)
+            {
+                SECURITY->log_syslog("CRITICAL", sprintf("%s: %-11s on %-11s " +
+                    "(crit pen = %d; hp - dam = %d - %d%s), freq %d\n\t%s on %s\n",
+                    ctime(time()),  capitalize(me->query_real_name()),
+                    capitalize(attack_ob->query_real_name()), pen,
+                    attack_ob->query_hp(), hitresult[3],
+                    ((attack_ob->query_hp() <= hitresult[3]) ? " LETHAL" : ""),
+                    crit_freq, file_name(me), file_name(attack_ob)), LOG_SIZE_100K);
             }
         }
+        else
+        {
+            hitresult = attack_ob->hit_me(hitsuc, 0, me, id);
+        }
+
+        /*
+         * Generate combat message, arguments Attack id, hitloc description
+         * proc_hurt, Defender
+         */
+        if (hitsuc > 0)
+        {
+            hitsuc = attack[ATT_WCPEN][tmp];
+            if (hitsuc > 0)
+            {
+                hitsuc = 100 * hitresult[2] / hitsuc;
+            }
+            else
+            {
+                hitsuc = 0;
+            }
+        }
+        if (hitresult[1])
+        {
+            cb_did_hit(id, hitresult[1], hitresult[4], hitresult[0],
+                   attack_ob, dt, hitsuc, hitresult[3]);
+            if (crit)
+            {
+                  cb_did_crit(id, hitresult[1], hitresult[4],
+                      hitresult[0], attack_ob, dt, hitsuc, hitresult[3]);
+            }
+        }
+        else
+        {
+            break; /* Ghost, linkdeath, immortals etc */
+        }
+
+        /* Oops, Lifeform turned into a deadform. Reward the killer. */
+        if (attack_ob->query_hp() <= 0)
+        {
+            enemies = enemies - ({ attack_ob });
+            attack_ob->do_die(me);
+            break;
+        }
     }
 
+    round_watchers = 0;
+
     /*
      * We might actually turn into a deadform here also,
      * some armours do damage when they're hit.
@@ -2527,6 +2683,26 @@ cb_update_attack()
 }
 
 
+/*
+ * Function name: update_attack_table
+ * Description:   Recompute the cached %use of each attack and their sum,
+ *                used to select the attacks each round. Called whenever the
+ *                table went stale after a change to the attacks.
+ */
+static void
+update_attack_table()
+{
+    int size = sizeof(attacks);
+
+    attack_procu = allocate(size);
+    attack_total = 0;
+    for (int i = 0; i < size; i++)
+    {
+        attack_procu[i] = attacks[i][ATT_PROCU];
+        attack_total += attack_procu[i];
+    }
+}
+
 /*
  * Function name: update_modified_pen
  * Description:   Recompute the stat-modified pen of all attacks.
@@ -2632,13 +2808,14 @@ add_attack(int wchit, mixed wcpen, int dt, int prcuse, int id, int skill,
     {
         att_id += ({ id });
         attacks += ({ ({ wchit, pen, dt, prcuse, skill, m_pen, wep }) });
-        return 1;
     }
     else
     {
         attacks[pos] = ({ wchit, pen, dt, prcuse, skill, m_pen, wep });
     }
 
+    /* The selection table is rebuilt at the next round. */
+    attack_procu = 0;
     return 1;
 }
 
@@ -2657,6 +2834,7 @@ remove_attack(int id)
     {
         attacks = exclude_array(attacks, pos, pos);
         att_id = exclude_array(att_id, pos, pos);
+        attack_procu = 0;
         return 1;
     }
 
@@ -10,6 +10,7 @@
 inherit "/std/object";
 inherit "/lib/keep";
 
+#include <files.h>
 #include <macros.h>
 #include <stdproperties.h>
 #include <composite.h>
@@ -33,6 +34,36 @@ static  mapping   cont_sublocs,    /* Map of sublocations and the object res-
                                       ponsible for the subloc, in container */
                   cont_subloc_ids; /* Map of sublocation ids to sublocation */
 
+/*
+ * Changes in light, weight and volume are not passed on to the environment
+ * immediately, but collected until the end of the evaluation.
+ *
+ * cont_pending     - ({ light, weight, volume }) not yet passed on.
+ * cont_pending_env - the environment the pending changes are meant for.
+ * cont_dirty_inv   - ([ container : 1 ]) containers in our inventory that
+ *                    may still have changes pending for us.
+ * cont_flush_queued - true if we are on the flush list of CONTAINER_FLUSH,
+ *                    which passes on the changes at the end of the
+ *                    evaluation.
+ */
+static  int      *cont_pending,
+                  cont_flush_queued;
+static  object    cont_pending_env;
+static  mapping   cont_dirty_inv;
+
+/*
+ * cont_heaps - ([ string heap id : ({ heaps }) ]) the heaps in our inventory
+ *              by their HEAP_S_UNIQUE_ID, so heaps can merge without looking
+ *              at the whole inventory.
+ */
+static  mapping   cont_heaps;
+
+/*
+ * cont_desc_stamp - raised whenever the description of our inventory may
+ *                   change, so kept composite descriptions of it expire.
+ */
+static  int       cont_desc_stamp = 1;
+
 /*
  * container_objects = ([ (string)filename :
  *     ({ (int)count, (function)condition, (function)init_call, (object *)clones }) ])
@@ -47,6 +78,10 @@ void create_container();
 void reset_container();
 void reset_auto_objects();
 void update_internal(int l, int w, int v);
+public void flush_internal();
+static void flush_dirty_inventory();
+static void add_heap_index(object ob, string id);
+static void remove_heap_index(object ob, mixed id);
 public int light();
 public nomask int weight();
 public nomask int volume();
@@ -63,6 +98,8 @@ public varargs string show_sublocs(object for_obj, mixed *slocs);
 public nomask void
 create_object()
 {
+    cont_dirty_inv = ([ ]);
+    cont_heaps = ([ ]);
     cont_block_prop = 0;
     add_prop(CONT_I_IN, 1);         /* Can have things inside it */
     add_prop(OBJ_I_LIGHT, light);   /* The total light of container */
@@ -132,6 +169,9 @@ reset_container()
 public int
 volume_left()
 {
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     if (query_prop(CONT_I_RIGID))
         return query_prop(CONT_I_MAX_VOLUME) - query_prop(CONT_I_VOLUME) -
             cont_cur_volume;
@@ -145,7 +185,13 @@ volume_left()
  * Returns:       Lightvalue
  */
 public int
-query_internal_light() { return cont_cur_light; }
+query_internal_light()
+{
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
+    return cont_cur_light;
+}
 
 /*
  * Function name: light
@@ -158,6 +204,9 @@ light()
 {
     int li = query_prop(CONT_I_LIGHT);
 
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     if (query_prop(CONT_I_TRANSP) ||
         query_prop(CONT_I_ATTACH) ||
         !query_prop(CONT_I_CLOSED))
@@ -183,6 +232,9 @@ weight()
 {
     int wi = query_prop(CONT_I_WEIGHT);
 
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     if (cont_linkroom)
         return cont_linkroom->query_prop(OBJ_I_WEIGHT) + wi;
     else
@@ -203,6 +255,8 @@ volume()
 
     if (query_prop(CONT_I_RIGID))
         return query_prop(CONT_I_MAX_VOLUME);
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
     vo = query_prop(CONT_I_VOLUME);
     if (cont_linkroom)
         return cont_linkroom->query_prop(OBJ_I_VOLUME) + vo;
@@ -260,11 +314,20 @@ public void
 enter_inv(object ob, object from)
 {
     int l, w, v;
+    string id;
 
     if (cont_linkroom)
     {
         ob->move(cont_linkroom, 1);
     }
+    /* A heap may already have merged into another on its way in. */
+    else if (stringp(id = ob->query_prop(HEAP_S_UNIQUE_ID)) &&
+        (environment(ob) == this_object()))
+    {
+        add_heap_index(ob, id);
+    }
+
+    cont_desc_stamp++;
 
     l = ob->query_prop(OBJ_I_LIGHT);
     w = ob->query_prop(OBJ_I_WEIGHT);
@@ -300,6 +363,15 @@ leave_inv(object ob, object to)
 {
     int l, w, v;
 
+    cont_desc_stamp++;
+
+    /* Make sure we know about its changes before we take it out. */
+    if (cont_dirty_inv[ob])
+        ob->flush_internal();
+
+    if (m_sizeof(cont_heaps))
+        remove_heap_index(ob, ob->query_prop(HEAP_S_UNIQUE_ID));
+
     if (cont_linkroom)
         return;
 
@@ -321,6 +393,9 @@ enter_env(object dest, object old)
 {
     int weight, vol;
 
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     if (dest)
     {
         weight = -cont_cur_weight + cont_cur_weight * 100 /
@@ -347,6 +422,9 @@ leave_env(object from, object to)
 {
     int weight, vol;
 
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     if (from)
     {
         weight = cont_cur_weight - cont_cur_weight * 100 /
@@ -362,10 +440,85 @@ leave_env(object from, object to)
     }
 }
 
+/*
+ * Function name: add_heap_index
+ * Description:   Register a heap in our inventory by its unique id.
+ * Arguments:     object ob - the heap.
+ *                string id - its HEAP_S_UNIQUE_ID.
+ */
+static void
+add_heap_index(object ob, string id)
+{
+    if (pointerp(cont_heaps[id]))
+        cont_heaps[id] = (cont_heaps[id] - ({ ob, 0 })) + ({ ob });
+    else
+        cont_heaps[id] = ({ ob });
+}
+
+/*
+ * Function name: remove_heap_index
+ * Description:   Remove a heap from the index.
+ * Arguments:     object ob - the heap.
+ *                mixed id  - its HEAP_S_UNIQUE_ID.
+ */
+static void
+remove_heap_index(object ob, mixed id)
+{
+    if (!stringp(id) || !pointerp(cont_heaps[id]))
+        return;
+
+    if (sizeof(cont_heaps[id] -= ({ ob, 0 })))
+        return;
+
+    m_delkey(cont_heaps, id);
+}
+
+/*
+ * Function name: query_heap_index
+ * Description:   Find the heaps with a certain unique id in our inventory.
+ *                This is used by heaps to find a heap to merge with.
+ * Arguments:     string id - the HEAP_S_UNIQUE_ID to look for.
+ * Returns:       object * - the heaps.
+ */
+public object *
+query_heap_index(string id)
+{
+    if (!pointerp(cont_heaps[id]))
+        return ({ });
+
+    return cont_heaps[id] - ({ 0 });
+}
+
+/*
+ * Function name: inventory_desc_changed
+ * Description:   Called from an object in our inventory when the way it is
+ *                described has changed.
+ */
+public void
+inventory_desc_changed()
+{
+    cont_desc_stamp++;
+}
+
+/*
+ * Function name: query_desc_stamp
+ * Description:   Gives the stamp of the description of our inventory. It
+ *                changes whenever that description may have changed, which
+ *                lets the composite routines keep descriptions.
+ * Returns:       int - the stamp, always positive.
+ */
+public int
+query_desc_stamp()
+{
+    return cont_desc_stamp;
+}
+
 /*
  * Function name: update_internal
- * Description:   Updates the light, weight and volume of things inside
- *                also updates a possible environment.
+ * Description:   Updates the light, weight and volume of things inside.
+ *                The changes for a possible environment are collected and
+ *                passed on in one go at the end of the evaluation, or when
+ *                the environment needs to know them. See flush_internal().
  * Arguments:     l: Light diff.
  *                w: Weight diff.
  *                v: Volume diff.
@@ -373,7 +526,7 @@ leave_env(object from, object to)
 public void
 update_internal(int l, int w, int v)
 {
-    object ob, env;
+    object env;
 
     cont_cur_light += l;
     cont_cur_weight += w;
@@ -398,10 +551,97 @@ update_internal(int l, int w, int v)
     if (query_prop(CONT_I_RIGID))
         v = 0;
 
-    if (l || w || v)
-        env->update_internal(l,
-                w * 100 / env->query_prop(CONT_I_REDUCE_WEIGHT),
-                v * 100 / env->query_prop(CONT_I_REDUCE_VOLUME));
+    if (!l && !w && !v)
+        return;
+
+    /* Changes for a previous environment must not end up here. */
+    if (cont_pending && (cont_pending_env != env))
+        flush_internal();
+
+    if (cont_pending)
+    {
+        cont_pending[0] += l;
+        cont_pending[1] += w;
+        cont_pending[2] += v;
+        return;
+    }
+
+    cont_pending = ({ l, w, v });
+    cont_pending_env = env;
+    if (!cont_flush_queued)
+    {
+        cont_flush_queued = 1;
+        CONTAINER_FLUSH->add_container();
+        env->add_dirty_internal(this_object());
+    }
+}
+
+/*
+ * Function name: add_dirty_internal
+ * Description:   Called from a container in our inventory when it has
+ *                changes pending for us. We register ourselves with our
+ *                own environment in turn, so that a container higher up
+ *                knows it has to collect the changes before it can tell
+ *                its light, weight or volume.
+ * Arguments:     object ob - the container with pending changes.
+ */
+public void
+add_dirty_internal(object ob)
+{
+    cont_dirty_inv[ob] = 1;
+
+    if (cont_flush_queued || !environment())
+        return;
+
+    cont_flush_queued = 1;
+    CONTAINER_FLUSH->add_container();
+    environment()->add_dirty_internal(this_object());
+}
+
+/*
+ * Function name: flush_dirty_inventory
+ * Description:   Have all containers in our inventory with pending changes
+ *                pass them on to us.
+ */
+static void
+flush_dirty_inventory()
+{
+    object *obs = m_indexes(cont_dirty_inv);
+
+    cont_dirty_inv = ([ ]);
+    obs->flush_internal();
+}
+
+/*
+ * Function name: flush_internal
+ * Description:   Pass the collected changes in light, weight and volume
+ *                on to the environment. The changes of the containers in
+ *                our inventory are collected first, so the whole chain is
+ *                updated with one combined change per container.
+ */
+public void
+flush_internal()
+{
+    int *delta;
+    object env;
+
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
+    cont_flush_queued = 0;
+
+    if (!(delta = cont_pending))
+        return;
+
+    env = cont_pending_env;
+    cont_pending = 0;
+    cont_pending_env = 0;
+    if (!objectp(env))
+        return;
+
+    env->update_internal(delta[0],
+        delta[1] * 100 / env->query_prop(CONT_I_REDUCE_WEIGHT),
+        delta[2] * 100 / env->query_prop(CONT_I_REDUCE_VOLUME));
 }
 
 /*
@@ -413,14 +653,18 @@ update_light(int recursive)
 {
     object *ob_list = all_inventory(this_object());
 
-    cont_cur_light = 0;
-    if (!sizeof(ob_list))
-        return;
+    if (recursive)
+        ob_list->update_light(recursive);
 
+    /* Collect the pending changes before counting anew, or they would be
+     * added on top of the fresh count when they are flushed later.
+     */
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
+    cont_cur_light = 0;
     foreach(object ob: ob_list)
     {
-        if (recursive)
-            ob->update_light(recursive);
         cont_cur_light += ob->query_prop(OBJ_I_LIGHT);
     }
 }
@@ -439,6 +683,8 @@ notify_change_prop(string prop, mixed val, mixed old)
     if (old == val)
         return;
 
+    cont_desc_stamp++;
+
     switch(prop)
     {
     case CONT_I_LIGHT:
@@ -458,6 +704,12 @@ notify_change_prop(string prop, mixed val, mixed old)
         update_internal(0, 0, val - old);
         return;
 
+    case HEAP_S_UNIQUE_ID:
+        remove_heap_index(previous_object(), old);
+        if (stringp(val))
+            add_heap_index(previous_object(), val);
+        return;
+
     case CONT_I_ATTACH:
     case CONT_I_TRANSP:
     case CONT_I_CLOSED:
@@ -467,6 +719,10 @@ notify_change_prop(string prop, mixed val, mixed old)
         return;
     }
 
+    /* Pending light must be in before the distribution changes. */
+    if (m_sizeof(cont_dirty_inv))
+        flush_dirty_inventory();
+
     object pobj = previous_object();
     int n = pobj->query_internal_light();
     if (!n)
@@ -22,7 +22,6 @@ inherit "/std/container";
 #define DECAY_TIME   20          /* times DECAY_UNIT == minutes */
 #define DECAY_LIMIT  3           /* times DECAY_UNIT == minutes */
 #define DECAY_UNIT   60.0        /* one minute */
-#define DECAY_FUN    "decay_fun" /* Name of the intermediate decay routine. */
 
 /* Prototypes */
 void decay_fun();
@@ -73,7 +72,7 @@ create_container()
     seteuid(getuid());
 
     /* If the decay time is not set yet, set the default decay time.
-     * This automatically starts the decay alarm.
+     * This automatically starts the decay timer.
      */
     if (!decay)
     {
@@ -385,7 +384,7 @@ decay_remove()
 /*
  * Function name: decay_fun
  * Description  : First stage of decay. Decay to a heap of remains, and move
- *                all inventory into the room. Then set the alarm for the
+ *                all inventory into the room. Then set the timer for the
  *                second stage.
  */
 void
@@ -419,7 +418,7 @@ decay_fun()
  * Function name: set_decay
  * Description  : Sets the decay time in minutes. Preferably, only call this
  *                routine from within create_corpse(), not externally. It will
- *                reset the alarm time to the new decay time.
+ *                reset the timer to the new decay time.
  * Arguments    : int d - the decay time in minutes.
  */
 void
@@ -429,7 +428,7 @@ set_decay(int d)
 
     if (decay_id)
     {
-        remove_alarm(decay_id);
+        TIMER_WHEEL->remove_timer(decay_id);
         decay_id = 0;
     }
     if (!decay)
@@ -440,11 +439,11 @@ set_decay(int d)
     /* If we are too far away, do some decay first. */
     if (decay > DECAY_LIMIT)
     {
-        decay_id = set_alarm((itof(decay - DECAY_LIMIT) * DECAY_UNIT), 0.0, decay_fun);
+        decay_id = TIMER_WHEEL->add_timer((itof(decay - DECAY_LIMIT) * DECAY_UNIT), decay_fun);
     }
     else
     {
-        decay_id = set_alarm((itof(decay) * DECAY_UNIT), 0.0, decay_remove);
+        decay_id = TIMER_WHEEL->add_timer((itof(decay) * DECAY_UNIT), decay_remove);
     }
 }
 
@@ -468,15 +467,14 @@ query_decay()
 int
 query_decay_left()
 {
-    mixed call;
     int left;
 
-    /* If it is active, find out how much time left in the alarms. */
+    /* If it is active, find out how much time left in the timers. While
+     * the first stage is pending, the second stage is still to come. */
     if (decay_id)
     {
-        call = get_alarm(decay_id);
-        left = ftoi(call[2]);
-        if (call[1] == DECAY_FUN)
+        left = ftoi(max(0.0, TIMER_WHEEL->query_timer_left(decay_id)));
+        if (decay > DECAY_LIMIT)
             left += (DECAY_LIMIT * ftoi(DECAY_UNIT));
         return left;
     }
@@ -1136,7 +1136,14 @@ query_locked() { return lock_status; }
  * Description:   Set which rooms is on the other side
  */
 void
-set_other_room(string name) { other_room = name; }
+set_other_room(string name)
+{
+    other_room = name;
+
+    /* The room keeps track of where its doors lead. */
+    if (environment())
+        environment()->reset_neighbour_cache();
+}
 
 /*
  * Function name: query_other_room
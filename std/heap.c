@@ -430,15 +430,24 @@ public void
 force_heap_merge()
 {
     object *obs;
+    string id;
     int tmphide, tmpinvis;
 
     /* Don't merge if we are going to self-destruct. */
     if (query_prop(TEMP_OBJ_ABOUT_TO_DESTRUCT))
         return;
 
-    obs = filter(all_inventory(environment(this_object())) - ({ this_object() }),
-        &operator(==)(query_prop(HEAP_S_UNIQUE_ID), ) @ &->query_prop(HEAP_S_UNIQUE_ID));
-    obs = filter(obs, not @ &->query_prop(TEMP_OBJ_ABOUT_TO_DESTRUCT));
+    /* Containers keep an index of their heaps. Only scan the inventory of
+     * an environment that does not.
+     */
+    id = query_prop(HEAP_S_UNIQUE_ID);
+    if (!pointerp(obs = environment()->query_heap_index(id)))
+    {
+        obs = filter(all_inventory(environment()),
+            &operator(==)(id, ) @ &->query_prop(HEAP_S_UNIQUE_ID));
+    }
+    obs = filter(obs - ({ this_object() }),
+        not @ &->query_prop(TEMP_OBJ_ABOUT_TO_DESTRUCT));
 
     tmphide = !!query_prop(OBJ_I_HIDE);
     tmpinvis = !!query_prop(OBJ_I_INVIS);
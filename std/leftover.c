@@ -176,10 +176,11 @@ enter_env(object dest, object old)
 {
     ::enter_env(dest, old);
 
-    remove_alarm(decay_alarm);
+    TIMER_WHEEL->remove_timer(decay_alarm);
+    decay_alarm = 0;
     if (IS_ROOM_OBJECT(dest))
     {
-	decay_alarm = set_alarm(1.0, 0.0, decay_fun);
+	decay_alarm = TIMER_WHEEL->add_timer(1.0, decay_fun);
     }
 }
 
@@ -193,7 +194,7 @@ decay_fun()
 {
     if (--decay_time)
     {
-	decay_alarm = set_alarm(60.0, 0.0, decay_fun);
+	decay_alarm = TIMER_WHEEL->add_timer(60.0, decay_fun);
     }
     else
     {
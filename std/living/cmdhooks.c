@@ -7,6 +7,7 @@
  */
 
 #include <cmdparse.h>
+#include <files.h>
 #include <login.h>
 #include <macros.h>
 #include <std.h>
@@ -21,6 +22,18 @@ static string   *wiz_souls,             /* The wizard soul names */
                 *tool_souls,            /* The tool soul names */
                 say_string;             /* The last message said */
 
+/*
+ * soul_index - ([ string verb : ({ ({ string soul, int wizsoul }) }) ])
+ *              The souls that define each verb, in the order in which
+ *              they are tried. wizsoul is true for wizard and tool souls.
+ *              It is shared with the other livings that use the same
+ *              souls, see SOUL_INDEX. It is fetched anew when it is reset
+ *              to 0 or when its generation is out of date.
+ * soul_index_generation - the generation of the soul index.
+ */
+static mapping  soul_index;
+static int      soul_index_generation;
+
 /*
  * Prototypes
  */
@@ -29,6 +42,7 @@ public varargs int communicate(string str = "");
 public varargs int acommunicate(string str = "");
 public varargs int wcommunicate(string str = "");
 static int my_commands(string str);
+static void reset_soul_index();
 
 #define REOPEN_SOUL_ALLOWED ([ "exec_done_editing" : WIZ_CMD_NORMAL, \
                                "pad_done_editing"  : WIZ_CMD_NORMAL, \
@@ -283,6 +297,7 @@ load_wiz_souls()
     else
     {
         wiz_souls = ({ });
+        reset_soul_index();
         return 1;
     }
 
@@ -301,6 +316,7 @@ load_wiz_souls()
     }
 
     wiz_souls = start_souls(wiz_souls);
+    reset_soul_index();
     return 1;
 }
 
@@ -320,6 +336,7 @@ load_command_souls()
 
     soul_souls = start_souls(soul_souls);
     update_cmdsoul_list(soul_souls);
+    reset_soul_index();
     return 1;
 }
 
@@ -335,6 +352,7 @@ load_tool_souls()
         !interactive(this_object()))
     {
         tool_souls = ({});
+        reset_soul_index();
         return 0;
     }
 
@@ -348,106 +366,156 @@ load_tool_souls()
 
     tool_souls = start_souls(tool_souls);
     update_tool_list(tool_souls);
+    reset_soul_index();
     return 1;
 }
 
+/*
+ * Function name: reset_soul_index
+ * Description  : Forget the verb index of the souls. It is rebuilt the
+ *                next time a command is executed.
+ */
+static void
+reset_soul_index()
+{
+    soul_index = 0;
+}
+
+/*
+ * Function name: query_soul_list
+ * Description  : Find the souls that are tried for a command, in order.
+ *                Wizard and tool souls are only used by wizards.
+ * Returns      : string * - the filenames of the souls.
+ */
+static string *
+query_soul_list()
+{
+    /* Don't waste the wiz-souls and toolsouls on mortals. */
+    if (query_wiz_level())
+    {
+        return wiz_souls + tool_souls + soul_souls;
+    }
+
+    return soul_souls;
+}
+
+/*
+ * Function name: build_soul_index
+ * Description  : Get the index of verbs to the souls that define them.
+ */
+static void
+build_soul_index()
+{
+    int wiz;
+
+    if (query_wiz_level())
+    {
+        wiz = sizeof(wiz_souls) + sizeof(tool_souls);
+    }
+
+    soul_index = SOUL_INDEX->query_index(query_soul_list(), wiz);
+    soul_index_generation = SOUL_INDEX->query_generation();
+}
+
+/*
+ * Function name: load_missing_souls
+ * Description  : Try to load the souls that are not loaded. A soul that
+ *                failed to load, or was destructed to be updated, may
+ *                define verbs that are not in the index.
+ * Returns      : int 1/0 - a soul was loaded/all souls were loaded already.
+ */
+static int
+load_missing_souls()
+{
+    int loaded;
+
+    foreach(string soul: query_soul_list())
+    {
+        if (!find_object(soul))
+        {
+            catch(soul->teleledningsanka());
+            loaded = loaded || objectp(find_object(soul));
+        }
+    }
+
+    return loaded;
+}
+
+/*
+ * Function name: soul_command
+ * Description  : Try to perform a command in a soul.
+ * Arguments    : string soul - the filename of the soul.
+ *                int wizsoul - true for wizard and tool souls.
+ *                string verb - the verb.
+ *                string str  - the argument string.
+ * Returns      : int - -1 if the soul does not know the verb, else the
+ *                      result of the command.
+ */
+static int
+soul_command(string soul, int wizsoul, string verb, string str)
+{
+    object ob;
+    int    rv;
+
+    if (!(ob = find_object(soul)))
+    {
+        if (catch(soul->teleledningsanka()))
+            tell_object(this_object(), "Yikes, baaad soul: " + soul + "\n");
+        if (!(ob = find_object(soul)))
+            return -1;
+    }
+
+    if (!ob->exist_command(verb))
+        return -1;
+
+    if (!wizsoul)
+        return ob->do_command(verb, str);
+
+    ob->open_soul(0);
+    export_uid(ob);
+    ob->open_soul(1);
+    rv = ob->do_command(verb, str);
+    ob->open_soul(0);
+    if (SECURITY->query_restrict(query_real_name()) &
+        RESTRICT_LOG_COMMANDS)
+        SECURITY->log_restrict(verb, str);
+    return rv;
+}
+
 /*
  * Function name:   my_commands
- * Description:     Try to find and perform a command.
+ * Description:     Try to find and perform a command. The souls that
+ *                  define the verb are found in the soul index, which is
+ *                  fetched anew whenever the souls change.
  * Arguments:       str - the argument string.
  * Returns:         True if the command was found.
  */
 static int
 my_commands(string str)
 {
-    int    i, rv;
     object ob;
+    mixed  souls;
     string verb = query_verb();
-    int    size;
 
-    /* Don't waste the wiz-souls and toolsouls on mortals.
-     */
-    if (query_wiz_level())
+    if (!mappingp(soul_index) ||
+        (soul_index_generation != SOUL_INDEX->query_generation()))
     {
-        /* This construct with while is faster than any for-loop, so keep
-         * it this way.
-         */
-        size = sizeof(wiz_souls);
-        i = -1;
-        while(++i < size)
-        {
-            ob = find_object(wiz_souls[i]);
-            if (!ob)
-            {
-                if (catch(wiz_souls[i]->teleledningsanka()))
-                    tell_object(this_object(),
-                        "Yikes, baaad soul: " + wiz_souls[i] + "\n");
-                ob = find_object(wiz_souls[i]);
-                if (!ob)
-                    continue;
-            }
-            if (ob->exist_command(verb))
-            {
-                ob->open_soul(0);
-                export_uid(ob);
-                ob->open_soul(1);
-                rv = ob->do_command(verb, str);
-                ob->open_soul(0);
-		if (SECURITY->query_restrict(query_real_name()) &
-		    RESTRICT_LOG_COMMANDS)
-		    SECURITY->log_restrict(verb, str);
-                if (rv)
-                    return 1;
-            }
-        }
+        build_soul_index();
+    }
 
-        size = sizeof(tool_souls);
-        i = -1;
-        while(++i < size)
-        {
-            ob = find_object(tool_souls[i]);
-            if (!ob)
-            {
-                if (catch(tool_souls[i]->teleledningsanka()))
-                    tell_object(this_object(),
-                        "Yikes, baaad soul: " + tool_souls[i] + "\n");
-                ob = find_object(tool_souls[i]);
-                if (!ob)
-                    continue;
-            }
-            if (ob->exist_command(verb))
-            {
-                ob->open_soul(0);
-                export_uid(ob);
-                ob->open_soul(1);
-                rv = (int)ob->do_command(verb, str);
-                ob->open_soul(0);
-		if (SECURITY->query_restrict(query_real_name()) &
-		    RESTRICT_LOG_COMMANDS)
-		    SECURITY->log_restrict(verb, str);
-                if (rv)
-                    return 1;
-            }
-        }
+    /* The verb may be in a soul that was not loaded when we got the index. */
+    if (!pointerp(souls = soul_index[verb]) &&
+        load_missing_souls())
+    {
+        build_soul_index();
+        souls = soul_index[verb];
     }
 
-    size = sizeof(soul_souls);
-    i = -1;
-    while(++i < size)
+    if (pointerp(souls))
     {
-        ob = find_object(soul_souls[i]);
-        if (!ob)
-        {
-            if (catch(soul_souls[i]->teleledningsanka()))
-                tell_object(this_object(),
-                    "Yikes, baaad soul: " + soul_souls[i] + "\n");
-            ob = find_object(soul_souls[i]);
-            if (!ob)
-                continue;
-        }
-        if (ob->exist_command(verb))
+        foreach(mixed entry: souls)
         {
-            if (ob->do_command(verb, str))
+            if (soul_command(entry[0], entry[1], verb, str) > 0)
                 return 1;
         }
     }
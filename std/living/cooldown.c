@@ -1,38 +1,260 @@
 /*
  * Manages cooldowns in players.
+ *
+ * The active cooldowns are kept in a binary min-heap on the time they
+ * expire. Finding out whether a cooldown is active takes constant time,
+ * and triggering one takes logarithmic time. A single alarm is armed for
+ * the cooldown that expires first.
+ *
+ * The mapping cooldowns is only the image of the cooldowns in the save
+ * file. A cooldown that counts down only while the player is online is
+ * stored there with the time remaining. A cooldown that also counts down
+ * while the player is offline is stored with the real time it expires. The
+ * image is written by store_cooldowns() before the player is saved and is
+ * read back when the cooldowns are first used.
  */
 
 mapping cooldowns;
 
-static int cooldown_alarm_id;
-static float last_cooldown_time;
+/*
+ * cooldown_state - ([ key : ({ expires, callback, offline, position }) ])
+ * cooldown_heap  - the keys of the cooldowns, as a heap on the time they
+ *                  expire. The array is allocated ahead, only the first
+ *                  cooldown_heap_size elements are used.
+ */
+static mapping cooldown_state;
+static string *cooldown_heap;
+static int     cooldown_heap_size;
+static int     cooldown_alarm_id;
+static float   cooldown_alarm_time;
 
 #define COOLDOWN_TIME       (0)
 #define COOLDOWN_CALLBACK   (1)
 #define COOLDOWN_MAX    (86400000.0)  /* The max possible cooldown, if higher
                                        * than this the cooldown is real time. */
 
-static void update_cooldown_state(int mode);
+#define STATE_EXPIRES       (0)
+#define STATE_CALLBACK      (1)
+#define STATE_OFFLINE       (2)
+#define STATE_POSITION      (3)
+
+#define HEAP_CHUNK          (8)
+
+static void expire_cooldowns(int from_alarm = 0);
+
+/*
+ * Function name: cooldown_heap_set
+ * Description  : Put a cooldown in a position in the heap.
+ * Arguments    : int pos - the position.
+ *                string key - the cooldown.
+ */
+static void
+cooldown_heap_set(int pos, string key)
+{
+    cooldown_heap[pos] = key;
+    cooldown_state[key][STATE_POSITION] = pos;
+}
+
+/*
+ * Function name: cooldown_sift_up
+ * Description  : Move a cooldown up in the heap until its parent expires
+ *                no later than it does.
+ * Arguments    : int pos - the position of the cooldown.
+ */
+static void
+cooldown_sift_up(int pos)
+{
+    string key = cooldown_heap[pos];
+    float expires = cooldown_state[key][STATE_EXPIRES];
+    int parent;
+
+    while (pos > 0)
+    {
+        parent = (pos - 1) / 2;
+        if (cooldown_state[cooldown_heap[parent]][STATE_EXPIRES] <= expires)
+            break;
+
+        cooldown_heap_set(pos, cooldown_heap[parent]);
+        pos = parent;
+    }
+
+    cooldown_heap_set(pos, key);
+}
+
+/*
+ * Function name: cooldown_sift_down
+ * Description  : Move a cooldown down in the heap until its children expire
+ *                no earlier than it does.
+ * Arguments    : int pos - the position of the cooldown.
+ */
+static void
+cooldown_sift_down(int pos)
+{
+    string key = cooldown_heap[pos];
+    float expires = cooldown_state[key][STATE_EXPIRES];
+    int child;
+
+    while ((child = (pos * 2) + 1) < cooldown_heap_size)
+    {
+        if (((child + 1) < cooldown_heap_size) &&
+            (cooldown_state[cooldown_heap[child + 1]][STATE_EXPIRES] <
+             cooldown_state[cooldown_heap[child]][STATE_EXPIRES]))
+            child++;
+
+        if (cooldown_state[cooldown_heap[child]][STATE_EXPIRES] >= expires)
+            break;
+
+        cooldown_heap_set(pos, cooldown_heap[child]);
+        pos = child;
+    }
+
+    cooldown_heap_set(pos, key);
+}
+
+/*
+ * Function name: cooldown_heap_insert
+ * Description  : Add a new cooldown to the heap.
+ * Arguments    : string key - the cooldown.
+ *                float expires - the time it expires.
+ *                function callback - called when it expires.
+ *                int offline - true if it counts down while offline.
+ */
+static void
+cooldown_heap_insert(string key, float expires, function callback, int offline)
+{
+    if (!pointerp(cooldown_heap))
+        cooldown_heap = allocate(HEAP_CHUNK);
+    else if (cooldown_heap_size >= sizeof(cooldown_heap))
+        cooldown_heap += allocate(sizeof(cooldown_heap));
+
+    cooldown_state[key] = ({ expires, callback, offline, cooldown_heap_size });
+    cooldown_heap[cooldown_heap_size] = key;
+    cooldown_heap_size++;
+    cooldown_sift_up(cooldown_heap_size - 1);
+}
+
+/*
+ * Function name: cooldown_heap_pop
+ * Description  : Remove the cooldown that expires first from the heap.
+ * Returns      : string - the cooldown.
+ */
+static string
+cooldown_heap_pop()
+{
+    string key = cooldown_heap[0];
+
+    cooldown_heap_size--;
+    cooldown_heap[0] = cooldown_heap[cooldown_heap_size];
+    cooldown_heap[cooldown_heap_size] = 0;
+    m_delkey(cooldown_state, key);
+
+    if (cooldown_heap_size)
+        cooldown_sift_down(0);
+
+    return key;
+}
+
+/*
+ * Function name: arm_cooldown_alarm
+ * Description  : Make sure the alarm is set for the cooldown that expires
+ *                first, or that there is no alarm when there are no
+ *                cooldowns.
+ */
+static void
+arm_cooldown_alarm()
+{
+    float expires;
+
+    if (!cooldown_heap_size)
+    {
+        remove_alarm(cooldown_alarm_id);
+        cooldown_alarm_id = 0;
+        return;
+    }
+
+    expires = cooldown_state[cooldown_heap[0]][STATE_EXPIRES];
+    if (cooldown_alarm_id && (cooldown_alarm_time == expires))
+        return;
+
+    remove_alarm(cooldown_alarm_id);
+    cooldown_alarm_time = expires;
+    cooldown_alarm_id = set_alarm(max(0.0, expires - gettimeofday()), 0.0,
+        &expire_cooldowns(1));
+}
+
+/*
+ * Function name: load_cooldowns
+ * Description  : Read the cooldowns from the save file image into the heap
+ *                the first time they are used.
+ */
+static void
+load_cooldowns()
+{
+    float now;
+
+    if (mappingp(cooldown_state))
+        return;
+
+    cooldown_state = ([ ]);
+    if (!mappingp(cooldowns) || !m_sizeof(cooldowns))
+        return;
+
+    now = gettimeofday();
+    foreach (string key, mixed cooldown: cooldowns)
+    {
+        if (!pointerp(cooldown))
+            continue;
+
+        if (cooldown[COOLDOWN_TIME] > COOLDOWN_MAX)
+            cooldown_heap_insert(key, cooldown[COOLDOWN_TIME],
+                cooldown[COOLDOWN_CALLBACK], 1);
+        else
+            cooldown_heap_insert(key, now + cooldown[COOLDOWN_TIME],
+                cooldown[COOLDOWN_CALLBACK], 0);
+    }
+
+    arm_cooldown_alarm();
+}
+
+/*
+ * Function name: store_cooldowns
+ * Description  : Write the active cooldowns to the save file image. This is
+ *                called before the player is saved.
+ */
+static void
+store_cooldowns()
+{
+    float now = gettimeofday();
+
+    if (!mappingp(cooldown_state))
+        return;
+
+    cooldowns = ([ ]);
+    foreach (string key, mixed state: cooldown_state)
+    {
+        cooldowns[key] = ({ state[STATE_OFFLINE] ? state[STATE_EXPIRES] :
+            max(0.0, state[STATE_EXPIRES] - now), state[STATE_CALLBACK] });
+    }
+}
 
 string
 stat_cooldowns()
 {
-    update_cooldown_state(0);
+    if (!mappingp(cooldown_state) && !mappingp(cooldowns))
+        return "";
 
-    if (!cooldowns || !m_sizeof(cooldowns))
+    load_cooldowns();
+    if (!cooldown_heap_size)
         return "";
 
     float current = gettimeofday();
     string str = sprintf("%-30s %s\n", "Cooldown Key", "Remaining (s)");
 
-    foreach (string key, mixed cooldown: cooldowns)
+    foreach (string key, mixed state: cooldown_state)
     {
-        float left = current - cooldown[COOLDOWN_TIME];
-
-        if (cooldown[COOLDOWN_TIME] < COOLDOWN_MAX) {
-            left = cooldown[COOLDOWN_TIME];
-        }
-        str += sprintf("%-30s %f7.2\n", key, left);
+        str += sprintf("%-30s %7.2f%s\n", key,
+            max(0.0, state[STATE_EXPIRES] - current),
+            (state[STATE_OFFLINE] ? " (offline)" : ""));
     }
 
     return str + "\n";
@@ -56,32 +278,35 @@ stat_cooldowns()
 int
 trigger_cooldown(string key, float duration, int offline = 0, function expire = 0)
 {
-    if (!mappingp(cooldowns))
-        cooldowns = ([ ]);
+    mixed state;
 
-    /* Update time remaining and check if this is an extension */
-    update_cooldown_state(0);
+    load_cooldowns();
 
-    float now =  gettimeofday();
-    if (cooldowns[key])
-    {
-        float prev = cooldowns[key][COOLDOWN_TIME];
-        float left = prev > COOLDOWN_MAX ? prev - now : prev;
+    /* Clear the expired cooldowns, so this is not taken as an extension. */
+    float now = gettimeofday();
+    if (cooldown_heap_size &&
+        (cooldown_state[cooldown_heap[0]][STATE_EXPIRES] <= now))
+        expire_cooldowns();
 
+    if (pointerp(state = cooldown_state[key]))
+    {
         /* Is the current expiration longer? */
-        if (duration < prev) {
-            update_cooldown_state(1);
+        if (duration < (state[STATE_EXPIRES] - now))
             return 0;
-        }
 
-        cooldowns[key] = ({ offline ? now + duration : duration, expire });
+        /* The cooldown only gets later, so it can only move down. */
+        state[STATE_EXPIRES] = now + duration;
+        state[STATE_CALLBACK] = expire;
+        state[STATE_OFFLINE] = offline;
+        cooldown_sift_down(state[STATE_POSITION]);
+        arm_cooldown_alarm();
         call_hook(HOOK_COOLDOWN_REFRESH, key, duration);
     } else {
-        cooldowns[key] = ({ offline ? now + duration : duration, expire });
+        cooldown_heap_insert(key, now + duration, expire, offline);
+        arm_cooldown_alarm();
         call_hook(HOOK_COOLDOWN_START, key, duration);
     }
 
-    update_cooldown_state(1);
     return 1;
 }
 
@@ -93,71 +318,62 @@ trigger_cooldown(string key, float duration, int offline = 0, function expire =
 int
 query_cooldown(string key)
 {
-    if (!mappingp(cooldowns))
+    mixed state;
+
+    if (!mappingp(cooldown_state))
+    {
+        if (!mappingp(cooldowns))
+            return 0;
+
+        load_cooldowns();
+    }
+
+    if (!pointerp(state = cooldown_state[key]))
         return 0;
 
-    update_cooldown_state(0);
-    return pointerp(cooldowns[key]);
+    if (state[STATE_EXPIRES] > gettimeofday())
+        return 1;
+
+    /* The alarm has not caught up yet, so expire it now. */
+    expire_cooldowns();
+    return pointerp(cooldown_state[key]);
 }
 
 /*
- * Function name: update_cooldown_state
- * Description  : Clears any cooldowns which are expired and schedules the
+ * Function name: expire_cooldowns
+ * Description  : Clears the cooldowns which are expired and schedules the
  *                alarm for the next cooldown.
+ * Arguments    : int from_alarm - true when called from the alarm.
  */
 static void
-update_cooldown_state(int schedule = 1)
+expire_cooldowns(int from_alarm = 0)
 {
-    if (!mappingp(cooldowns))
-        return;
+    float now = gettimeofday();
+    function callback;
+    string key;
 
-    if (schedule && cooldown_alarm_id)
-    {
-        remove_alarm(cooldown_alarm_id);
+    if (from_alarm)
         cooldown_alarm_id = 0;
-    }
 
-    float now = gettimeofday();
-    float delta = last_cooldown_time ? now - last_cooldown_time : 0.0;
-    float next = 600.0;
-
-    foreach (string key, mixed cooldown: cooldowns)
+    while (cooldown_heap_size &&
+        (cooldown_state[cooldown_heap[0]][STATE_EXPIRES] <= now))
     {
-        float expiration = cooldown[COOLDOWN_TIME];
-        float left;
-
-        if (expiration > COOLDOWN_MAX)
-        {
-            left = expiration - now;
-        } else  {
-            cooldown[COOLDOWN_TIME] -= delta;
-            left = cooldown[COOLDOWN_TIME];
-        }
+        callback = cooldown_state[cooldown_heap[0]][STATE_CALLBACK];
+        key = cooldown_heap_pop();
+        call_hook(HOOK_COOLDOWN_EXPIRED, key);
 
-         if (left <= 0.0) {
-            function callback =  cooldown[COOLDOWN_TIME];
-            m_delkey(cooldowns, key);
-            call_hook(HOOK_COOLDOWN_EXPIRED, key);
-
-            if (functionp(callback)) {
-                try {
-                    callback();
-                } catch (string err) {
-                    if (query_wiz_level())
-                        tell_object(this_object(), err);
-                    else
-                       tell_object(this_object(), "You notice a wrongness in " +
-                        "the fabric of space.\n");
-                }
+        if (functionp(callback)) {
+            try {
+                callback();
+            } catch (string err) {
+                if (query_wiz_level())
+                    tell_object(this_object(), err);
+                else
+                   tell_object(this_object(), "You notice a wrongness in " +
+                    "the fabric of space.\n");
             }
-
-         } else if (left < next) {
-            next = left;
-         }
+        }
     }
 
-    last_cooldown_time = now;
-
-    if (schedule)
-        cooldown_alarm_id = set_alarm(next, 0.0, &update_cooldown_state());
+    arm_cooldown_alarm();
 }
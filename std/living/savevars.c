@@ -785,6 +785,103 @@ gmcp_char_vitals()
         GET_NUM_DESC_SUB(maximum - fatigue, maximum, SD_FATIGUE, SD_STAT_DENOM, 1));
 }
 
+/*
+ * Function name: next_desc_time
+ * Description  : Find out when a value that changes by a fixed amount each
+ *                interval gets another description through GET_NUM_DESC or
+ *                GET_NUM_DESC_SUB.
+ * Arguments    : int value   - the value at the time of the last change.
+ *                int maximum - the maximum of the value.
+ *                int descs   - the number of descriptions.
+ *                int rate    - the change per interval, negative to decay.
+ *                int last    - the time of the last change.
+ *                int interval - the interval in seconds.
+ *                int zero    - if true, 0 has a description of its own.
+ * Returns      : int - the time of the next change of description, or 0
+ *                      if it will not change.
+ */
+static int
+next_desc_time(int value, int maximum, int descs, int rate, int last,
+    int interval, int zero)
+{
+    int desc, target;
+
+    maximum = max(maximum, 1);
+    value = min(max(value, 0), maximum);
+    desc = (min(value, maximum - 1) * descs) / maximum;
+
+    if (rate > 0)
+    {
+        if (desc >= (descs - 1))
+            return 0;
+        /* The lowest value with the next description. */
+        target = (((desc + 1) * maximum) + descs - 1) / descs;
+        return last + (((target - value + rate - 1) / rate) * interval);
+    }
+
+    if ((rate == 0) || (value == 0))
+        return 0;
+
+    /* The highest value with the previous description. */
+    target = ((desc * maximum) + descs - 1) / descs - 1;
+    if (target < 0)
+    {
+        if (!zero)
+            return 0;
+        target = 0;
+    }
+    rate = -rate;
+    return last + (((value - target + rate - 1) / rate) * interval);
+}
+
+/*
+ * Function name: query_vitals_next_change
+ * Description  : Find out when the description of one of the vitals that
+ *                heal or decay over time will change next. Where the rate
+ *                of healing depends on something that changes as well, the
+ *                fastest rate is used, so the time is never too late.
+ * Returns      : int - the time of the next change, or 0 if none of the
+ *                      vitals will change by itself.
+ */
+public int
+query_vitals_next_change()
+{
+    int next;
+    int *times;
+
+    times = ({
+        next_desc_time(hit_points, query_max_hp(), sizeof(SD_HEALTH),
+            F_HEAL_FORMULA(max(query_stat(SS_CON), last_con),
+            max(intoxicated, last_intox)), hp_time,
+            F_INTERVAL_BETWEEN_HP_HEALING, 0),
+        next_desc_time(mana, query_max_mana(), sizeof(SD_MANA),
+            F_MANA_HEAL_FORMULA(query_skill(SS_SPELLCRAFT), 0,
+            query_stat(SS_WIS)), mana_time,
+            F_INTERVAL_BETWEEN_MANA_HEALING, 0),
+        next_desc_time(query_max_fatigue() - fatigue, query_max_fatigue(),
+            sizeof(SD_FATIGUE) * sizeof(SD_STAT_DENOM),
+            -F_FATIGUE_FORMULA(max(stuffed, last_stuffed),
+            query_prop(LIVE_I_MAX_EAT)), fatigue_time,
+            F_INTERVAL_BETWEEN_FATIGUE_HEALING, 0),
+        next_desc_time(intoxicated, query_prop(LIVE_I_MAX_INTOX),
+            sizeof(SD_INTOX) * sizeof(SD_STAT_DENOM), -F_SOBER_RATE,
+            intoxicated_time, F_INTERVAL_BETWEEN_INTOX_HEALING, 1),
+        next_desc_time(stuffed, query_prop(LIVE_I_MAX_EAT), sizeof(SD_STUFF),
+            -F_UNSTUFF_RATE, stuffed_time,
+            F_INTERVAL_BETWEEN_STUFFED_HEALING, 0),
+        next_desc_time(soaked, query_prop(LIVE_I_MAX_DRINK), sizeof(SD_SOAK),
+            -F_UNSOAK_RATE, soaked_time,
+            F_INTERVAL_BETWEEN_SOAKED_HEALING, 0) });
+
+    foreach(int when: times)
+    {
+        if (when && (!next || (when < next)))
+            next = when;
+    }
+
+    return next;
+}
+
 /*
  * Function name: set_acc_exp
  * Description  : Set the accumulated experience for each of the stats.
@@ -23,6 +23,11 @@ inherit "/lib/item_expiration";
 #define SEARCH_PARALYZE "_search_paralyze_"
 #define OBJ_I_SEARCH_ALARM_ID "_obj_i_search_alarm_id"
 
+/* Flags in the table of property masks, see query_prop_masks(). */
+#define PROP_MASK_KNOWN  1
+#define PROP_MASK_ADD    2
+#define PROP_MASK_REMOVE 4
+
 static string   obj_pshort,     /* Plural short description */
                 obj_subloc,     /* Current sublocation */
                *obj_names,      /* The name(s) of the object */
@@ -41,6 +46,7 @@ static int      obj_no_show,    /* Don't display this object. */
                 will_not_recover; /* True if it won't recover */
 static object   obj_previous;   /* Caller of function resulting in VBFC */
 static mapping  obj_props;      /* Object properties */
+static mapping  obj_prop_masks; /* Which properties have mask functions */
 private static int hb_alarm_id,    /* Identification of hearbeat callout */
                 reset_interval; /* Constant used to set reset interval */
 
@@ -536,6 +542,97 @@ adjectiv_id(string str)
     return (member_array(str, obj_adjs) >= 0);
 }
 
+/*
+ * Function name: prop_mask_table
+ * Description  : Gives the table of which properties have a mask function
+ *                "add_prop" + prop or "remove_prop" + prop in this program.
+ *                The table is shared by the master object and all clones of
+ *                the same program. It is filled as properties are used.
+ * Returns      : mapping - ([ string prop : int flags ])
+ */
+static mapping
+prop_mask_table()
+{
+    object master_ob;
+
+    if (mappingp(obj_prop_masks))
+    {
+        return obj_prop_masks;
+    }
+
+    /* Clones use the table of their master object, unless the master was
+     * loaded after we were made, because then it may be another program.
+     */
+    if (objectp(master_ob = find_object(MASTER)) &&
+        (master_ob != this_object()) &&
+        (object_time(master_ob) <= object_time(this_object())))
+    {
+        obj_prop_masks = master_ob->query_prop_mask_table();
+    }
+
+    if (!mappingp(obj_prop_masks))
+    {
+        obj_prop_masks = ([ ]);
+    }
+
+    return obj_prop_masks;
+}
+
+/*
+ * Function name: query_prop_mask_table
+ * Description  : Gives the table of property masks, see prop_mask_table().
+ *                Only our clones get the table itself, to share it. Anyone
+ *                else gets a copy, so they cannot hide our mask functions.
+ * Returns      : mapping - ([ string prop : int flags ])
+ */
+public nomask mapping
+query_prop_mask_table()
+{
+    if ((previous_object() != this_object()) &&
+        CALL_BY_CLONE)
+    {
+        return prop_mask_table();
+    }
+
+    return ([ ]) + prop_mask_table();
+}
+
+/*
+ * Function name: query_prop_masks
+ * Description  : Find out whether a property has mask functions. When the
+ *                object is shadowed, a shadow may define a mask, so then
+ *                we always say there might be one.
+ * Arguments    : string prop - the property.
+ * Returns      : int - the PROP_MASK_ flags for the property.
+ */
+static int
+query_prop_masks(string prop)
+{
+    int flags;
+
+    if (shadow(this_object(), 0))
+    {
+        return PROP_MASK_KNOWN | PROP_MASK_ADD | PROP_MASK_REMOVE;
+    }
+
+    if (!mappingp(obj_prop_masks))
+    {
+        prop_mask_table();
+    }
+
+    if (!(flags = obj_prop_masks[prop]))
+    {
+        flags = PROP_MASK_KNOWN |
+            (function_exists("add_prop" + prop, this_object()) ?
+                PROP_MASK_ADD : 0) |
+            (function_exists("remove_prop" + prop, this_object()) ?
+                PROP_MASK_REMOVE : 0);
+        obj_prop_masks[prop] = flags;
+    }
+
+    return flags;
+}
+
 /*
  * Function name: add_prop
  * Description:   Add a property to the property list
@@ -569,7 +666,8 @@ add_prop(string prop, mixed val)
         return;
     }
 
-    if (call_other(this_object(), "add_prop" + prop, val))
+    if ((query_prop_masks(prop) & PROP_MASK_ADD) &&
+        call_other(this_object(), "add_prop" + prop, val))
     {
         return;
     }
@@ -615,7 +713,8 @@ remove_prop(string prop)
         return;
     }
 
-    if (call_other(this_object(), "remove_prop" + prop))
+    if ((query_prop_masks(prop) & PROP_MASK_REMOVE) &&
+        call_other(this_object(), "remove_prop" + prop))
     {
         return;
     }
@@ -804,6 +903,12 @@ move(mixed dest, mixed subloc)
     if (!objectp(dest))
         dest = old;
 
+    /* A container must pass on its pending changes, and collect those of
+     * its own inventory, while it is still in the old environment.
+     */
+    if (old != dest)
+        this_object()->flush_internal();
+
     if (subloc == 1)
         move_object(dest);
 
@@ -1082,6 +1187,19 @@ reset_euid()
     seteuid(getuid());
 }
 
+/*
+ * Function name: update_desc_stamp
+ * Description  : Tell our environment that the way we are described has
+ *                changed, so that composite descriptions of its inventory
+ *                that were kept are no longer used.
+ */
+static void
+update_desc_stamp()
+{
+    if (environment())
+        environment()->inventory_desc_changed();
+}
+
 /*
  * Function name: add_list
  * Description:   Common routine for set_name, set_pname, set_adj etc
@@ -1098,6 +1216,8 @@ add_list(string *list, mixed elem, int first)
     if (obj_no_change)
         return list;
 
+    update_desc_stamp();
+
     if (pointerp(elem))
         e = elem;
     else
@@ -1129,6 +1249,8 @@ del_list(string *list_old, mixed list_del)
     if (!list_old)
         return list_old;
 
+    update_desc_stamp();
+
     if (!pointerp(list_del))
         list_del = ({ list_del });
 
@@ -1451,6 +1573,7 @@ set_short(mixed short)
 {
     if (!obj_no_change)
         obj_short = short;
+    update_desc_stamp();
 }
 
 /*
@@ -1466,6 +1589,7 @@ set_pshort(mixed pshort)
 {
     if (!obj_no_change)
         obj_pshort = pshort;
+    update_desc_stamp();
 }
 
 /*
@@ -1524,6 +1648,7 @@ public void
 unset_no_show()
 {
     obj_no_show = 0;
+    update_desc_stamp();
 }
 
 /*
@@ -1546,6 +1671,7 @@ void
 set_no_show_composite(int i)
 {
     obj_no_show_c = i;
+    update_desc_stamp();
 }
 
 /*
@@ -1556,6 +1682,7 @@ void
 unset_no_show_composite()
 {
     obj_no_show_c = 0;
+    update_desc_stamp();
 }
 
 /*
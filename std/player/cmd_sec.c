@@ -227,6 +227,7 @@ save_me(int manual)
     set_logout_time();
     set_logout_location();
     store_saved_props();
+    store_cooldowns();
 
     seteuid(0);
     SECURITY->save_player();
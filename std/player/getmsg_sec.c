@@ -23,8 +23,12 @@ static string  gmcp_client,      /* GMCP client name */
                gmcp_version,     /* GMCP client version */
                gmcp_mapfile,     /* last loaded mapfile */
                gmcp_section;     /* last loaded mapsection */
+static int     gmcp_vitals_alarm, /* alarm for the next change in vitals */
+               gmcp_outbox_alarm; /* alarm to send the char outbox */
+static mapping gmcp_outbox = ([ ]); /* ([ package : ([ name : value ]) ]) */
 
 nomask public void gmcp_team();
+nomask public void gmcp_refresh();
 
 /************************************************************************
  *
@@ -475,10 +479,37 @@ set_gmcp_client(mixed data)
     }
 }
 
+/*
+ * Function name: gmcp_schedule_vitals
+ * Description  : Set the alarm for the next time the description of one of
+ *                our vitals changes by itself, so the GMCP client can be
+ *                told about it. When none will change, there is no alarm.
+ */
+static void
+gmcp_schedule_vitals()
+{
+    int when;
+
+    remove_alarm(gmcp_vitals_alarm);
+    gmcp_vitals_alarm = 0;
+
+    if (!m_gmcp[GMCP_CHAR] ||
+        !(when = this_object()->query_vitals_next_change()))
+    {
+        return;
+    }
+
+    /* A second later, so the healing interval has surely passed. */
+    gmcp_vitals_alarm = set_alarm(itof(max(when - time(), 0) + 1), 0.0,
+        gmcp_refresh);
+}
+
 /*
  * Function name: gmcp_refresh
- * Description  : Called from SECURITY from time to time to update the
- *                vitals so that we can give messages going up as well.
+ * Description  : Called by alarm when the description of one of our vitals
+ *                is due to change. We update the vitals so that the GMCP
+ *                client also gets the messages going up, and then schedule
+ *                the next change.
  */
 nomask public void
 gmcp_refresh()
@@ -492,11 +523,46 @@ gmcp_refresh()
         query_soaked();
         query_intoxicated();
     }
+
+    gmcp_schedule_vitals();
+}
+
+/*
+ * Function name: gmcp_flush_char
+ * Description  : Send all updates of the char packages collected during the
+ *                evaluation, one message per package.
+ */
+static void
+gmcp_flush_char()
+{
+    mapping outbox = gmcp_outbox;
+
+    gmcp_outbox = ([ ]);
+    remove_alarm(gmcp_outbox_alarm);
+    gmcp_outbox_alarm = 0;
+
+    if (!m_gmcp[GMCP_CHAR])
+    {
+        return;
+    }
+
+    foreach(string package, mapping data: outbox)
+    {
+        catch_gmcp(package, data);
+    }
+
+    /* A change in the vitals may change when the next one is due. */
+    if (outbox[GMCP_CHAR_VITALS])
+    {
+        gmcp_schedule_vitals();
+    }
 }
 
 /*
  * Function name: gmcp_char
- * Description  : Updates the char package with a new value.
+ * Description  : Updates the char package with a new value. The updates
+ *                are collected and sent per package at the end of the
+ *                evaluation, so several changes go in a single message.
  * Arguments    : string package - the package to update
  *                string name - the name of the variable
  *                mixed value - the new value
@@ -504,9 +570,20 @@ gmcp_refresh()
 nomask public void
 gmcp_char(string package, string name, mixed value)
 {
-    if (m_gmcp[GMCP_CHAR])
+    if (!m_gmcp[GMCP_CHAR])
+    {
+        return;
+    }
+
+    if (!mappingp(gmcp_outbox[package]))
+    {
+        gmcp_outbox[package] = ([ ]);
+    }
+    gmcp_outbox[package][name] = value;
+
+    if (!gmcp_outbox_alarm)
     {
-        catch_gmcp(package, ([ name : value ]) );
+        gmcp_outbox_alarm = set_alarm(0.0, 0.0, gmcp_flush_char);
     }
 }
 
@@ -1260,6 +1260,17 @@ set_option(int opt, int val)
         ::set_whimpy(val);
         return 1;
 
+    case OPT_GAG_MISSES:
+    case OPT_NO_FIGHTS:
+        if (val)
+            options = efun::set_bit(options, OPT_BASE + opt);
+        else
+            options = efun::clear_bit(options, OPT_BASE + opt);
+        /* Let the room know whether we still watch the fights. */
+        if (environment())
+            environment()->update_fight_audience(this_object());
+        return 1;
+
     case OPT_ALWAYS_KNOWN:
         add_prop(LIVE_I_ALWAYSKNOWN, val);
         /* Intentional fallthrough. */
@@ -1271,10 +1282,8 @@ set_option(int opt, int val)
     case OPT_BLOCK_INTIMATE:
     case OPT_BRIEF:
     case OPT_ECHO:
-    case OPT_GAG_MISSES:
     case OPT_GIFT_FILTER:
     case OPT_MERCIFUL_COMBAT:
-    case OPT_NO_FIGHTS:
     case OPT_SHOW_UNMET:
     case OPT_SILENT_SHIPS:
     case OPT_TABLE_INVENTORY:
@@ -66,7 +66,7 @@ int    silent;   /* 0 - poisonee gets messages                          */
 int    recovery; /* if set to 1 this is a recovery after you quit       */
 int    *damage;  /* The damage the poison can do                        */
 int    a_dam;    /* The id of the damage_player alarm                   */
-int    a_time;   /* The id of the time_out alarm                        */
+int    a_time;   /* The id of the time_out timer in the timer wheel     */
 int    no_cleanse; /* If true, then this poison cannot be cleansed.     */
 string type;     /* The type of the poison, to match for cure           */
 object poisonee; /* The victim that is being poisoned                   */
@@ -259,11 +259,11 @@ query_time()
 public int
 query_time_left()
 {
-    mixed arr;
+    float left;
 
-    if (a_time && sizeof(arr = get_alarm(a_time)))
+    if (a_time && ((left = TIMER_WHEEL->query_timer_left(a_time)) >= 0.0))
     {
-        return ftoi(arr[2]);
+        return ftoi(left);
     }
     else if (query_prop(POISON_F_TIME_LEFT))
     {
@@ -397,7 +397,7 @@ kill_player()
 {
     if (a_time)
     {
-        remove_alarm(a_time);
+        TIMER_WHEEL->remove_timer(a_time);
     }
     a_time = 0;
 
@@ -648,7 +648,7 @@ start_poison(object poisoner)
             damage_player);
     }
 
-    a_time = set_alarm(p_time, 0.0, timeout);
+    a_time = TIMER_WHEEL->add_timer(p_time, timeout);
 }
 
 /*
@@ -743,7 +743,7 @@ cure_poison(string *cure_type, int success)
     {
         if (a_time)
         {
-            remove_alarm(a_time);
+            TIMER_WHEEL->remove_timer(a_time);
         }
         a_time = 0;
         timeout();
@@ -762,7 +762,7 @@ remove_object()
 {
     if (a_time)
     {
-        remove_alarm(a_time);
+        TIMER_WHEEL->remove_timer(a_time);
     }
 
     ::remove_object();
@@ -779,7 +779,6 @@ remove_object()
 public void
 linkdeath_hook(object player, int linkdeath)
 {
-    mixed arr;
     float time_left;
 
     /* Player linkdies. */
@@ -792,11 +791,11 @@ linkdeath_hook(object player, int linkdeath)
         }
 
         /* Find out how much time there is left. */
-        if (sizeof(arr = get_alarm(a_time)))
+        if ((time_left = TIMER_WHEEL->query_timer_left(a_time)) >= 0.0)
         {
-            add_prop(POISON_F_TIME_LEFT, arr[2]);
+            add_prop(POISON_F_TIME_LEFT, time_left);
         }
-        remove_alarm(a_time);
+        TIMER_WHEEL->remove_timer(a_time);
         a_time = 0;
         remove_alarm(a_dam);
         a_dam = 0;
@@ -816,7 +815,7 @@ linkdeath_hook(object player, int linkdeath)
                 damage_player);
         }
 
-        a_time = set_alarm(time_left, 0.0, timeout);
+        a_time = TIMER_WHEEL->add_timer(time_left, timeout);
     }
 }
 
@@ -846,7 +845,6 @@ query_auto_load()
     string dam_string = "";
     int index;
     int prevent_cleanse = no_cleanse;
-    mixed arr;
 
     for (index = 0; index < sizeof(damage); index++)
     {
@@ -861,9 +859,9 @@ query_auto_load()
             time_left = 0.0;
         }
     }
-    else if (sizeof(arr = get_alarm(a_time)))
+    else
     {
-        time_left = arr[2];
+        time_left = max(0.0, TIMER_WHEEL->query_timer_left(a_time));
     }
 
     /* When a posion is kept while quitting, half of the time that already
@@ -12,6 +12,7 @@ inherit "/std/container";
 #include <files.h>
 #include <filter_funs.h>
 #include <macros.h>
+#include <options.h>
 #include <ss_types.h>
 #include <std.h>
 #include <stdproperties.h>
@@ -26,6 +27,8 @@ inherit "/std/container";
 
 static object   room_link_cont;	/* Linked container */
 static object   *accept_here = ({ }); /* Items created here on roomcreation */
+static object   *audience_fights = 0; /* Onlookers that watch fights here */
+static object   *audience_misses = 0; /* Onlookers that also watch misses */
 
 /*
  * Function name: create_room
@@ -244,6 +247,118 @@ update_internal(int l, int w, int v)
     }
 }
 
+/*
+ * Function name: add_fight_audience
+ * Description  : Add an object to the combat audience of this room if it
+ *                wants to see the fights of others.
+ * Arguments    : object ob - the object to add.
+ */
+static void
+add_fight_audience(object ob)
+{
+    if (!function_exists("catch_msg", ob) ||
+        ob->query_option(OPT_NO_FIGHTS))
+    {
+        return;
+    }
+
+    audience_fights += ({ ob });
+    if (!ob->query_option(OPT_GAG_MISSES))
+    {
+        audience_misses += ({ ob });
+    }
+}
+
+/*
+ * Function name: query_fight_audience
+ * Description  : Gives the objects in this room that watch the fights of
+ *                others, as used by the combat messages. The audience is
+ *                collected the first time it is asked for and is kept up to
+ *                date as objects enter and leave and change their options.
+ *                Whether an onlooker can see the fight is not part of it.
+ * Returns      : mixed * - ({ object *fights, object *misses }), where the
+ *                    onlookers in misses also want to see misses.
+ */
+public mixed *
+query_fight_audience()
+{
+    if (!pointerp(audience_fights))
+    {
+        audience_fights = ({ });
+        audience_misses = ({ });
+        foreach(object ob: all_inventory(this_object()))
+        {
+            add_fight_audience(ob);
+        }
+    }
+    else
+    {
+        audience_fights -= ({ 0 });
+        audience_misses -= ({ 0 });
+    }
+
+    return ({ audience_fights, audience_misses });
+}
+
+/*
+ * Function name: update_fight_audience
+ * Description  : Called when an object in this room changes its options
+ *                for watching fights.
+ * Arguments    : object ob - the object that changed its options.
+ */
+public void
+update_fight_audience(object ob)
+{
+    if (!pointerp(audience_fights) ||
+        (environment(ob) != this_object()))
+    {
+        return;
+    }
+
+    audience_fights -= ({ ob });
+    audience_misses -= ({ ob });
+    add_fight_audience(ob);
+}
+
+/*
+ * Function name: enter_inv
+ * Description  : Called when an object enters this room. Keeps the combat
+ *                audience up to date. If you redefine this function, you
+ *                must call ::enter_inv(ob, from).
+ * Arguments    : object ob - the object entering.
+ *                object from - where it came from.
+ */
+public void
+enter_inv(object ob, object from)
+{
+    ::enter_inv(ob, from);
+
+    if (pointerp(audience_fights))
+    {
+        add_fight_audience(ob);
+    }
+}
+
+/*
+ * Function name: leave_inv
+ * Description  : Called when an object leaves this room. Keeps the combat
+ *                audience up to date. If you redefine this function, you
+ *                must call ::leave_inv(ob, to).
+ * Arguments    : object ob - the object leaving.
+ *                object to - where it goes.
+ */
+public void
+leave_inv(object ob, object to)
+{
+    ::leave_inv(ob, to);
+
+    if (pointerp(audience_fights))
+    {
+        audience_fights -= ({ ob });
+        audience_misses -= ({ ob });
+    }
+}
+
 #if 0
 /*
  * Function name: hook_change_invis
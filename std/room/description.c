@@ -16,6 +16,8 @@
 #include <login.h>
 
 static  mixed   room_descs;        /* Extra longs added to the rooms own */
+static  mixed   room_descs_cache;  /* The extra longs, with the plain texts
+                                      joined and the VBFC kept apart. */
 static  int     searched;          /* Times this room has been searched */
 static  string *herbs;             /* WHat herbs grows in this room? */
 /* Buffer this as it's a rather costly call. */
@@ -44,6 +46,8 @@ add_my_desc(string str, object cobj)
         room_descs = ({ cobj, str });
     else
         room_descs = room_descs + ({ cobj, str });
+
+    room_descs_cache = 0;
 }
 
 /*
@@ -76,6 +80,8 @@ change_my_desc(string str, object cobj)
         add_my_desc(str, cobj);
     else
         room_descs[i + 1] = str;
+
+    room_descs_cache = 0;
 }
 
 /*
@@ -107,6 +113,8 @@ remove_my_desc(object cobj)
             room_descs = exclude_array(room_descs, i - 1, i);
         i = member_array(cobj, room_descs);
     }
+
+    room_descs_cache = 0;
 }
 
 /*
@@ -121,18 +129,93 @@ query_desc()
     return slice_array(room_descs, 0, sizeof(room_descs));
 }
 
+/*
+ * Function name: is_plain_text
+ * Description  : Find out whether a description is a plain string, i.e.
+ *                one that does not contain VBFC.
+ * Arguments    : mixed text - the description to test.
+ * Returns      : int 1/0 - plain or not.
+ */
+static int
+is_plain_text(mixed text)
+{
+    return (stringp(text) && !wildmatch("*@@*", text));
+}
+
+/*
+ * Function name: exits_describable
+ * Description  : Find out whether the lines about the exits can be cached.
+ *                This is not so when the visibility of an exit depends on
+ *                VBFC, or when the room redefines how exits are shown.
+ * Returns      : int 1/0 - cacheable or not.
+ */
+static int
+exits_describable()
+{
+    if (pointerp(non_obvious_exits))
+    {
+        foreach(mixed non_obvious: non_obvious_exits)
+        {
+            if (!intp(non_obvious))
+            {
+                return 0;
+            }
+        }
+    }
+
+    return ((function_exists("query_obvious_exits", this_object()) ==
+            ROOM_OBJECT) &&
+        (function_exists("query_noshow_obvious", this_object()) ==
+            ROOM_OBJECT) &&
+        (function_exists("query_exit_cmds", this_object()) ==
+            ROOM_OBJECT) &&
+        (function_exists("query_exit_order", this_object()) ==
+            ROOM_OBJECT));
+}
+
+/*
+ * Function name: exits_text
+ * Description  : Describe a list of exits in a sentence.
+ * Arguments    : string *exits - the exits.
+ *                string kind - "obvious" or "non-obvious".
+ * Returns      : string - the sentence, or "" if there are no exits.
+ */
+static string
+exits_text(string *exits, string kind)
+{
+    switch(sizeof(exits))
+    {
+    case 0:
+        return "";
+
+    case 1:
+        return "There is one " + kind + " exit: " + exits[0] + ".\n";
+
+    default:
+        return "There are " + LANG_WNUM(sizeof(exits)) + " " + kind +
+            " exits: " + COMPOSITE_WORDS(exits) + ".\n";
+    }
+}
+
 /*
  * Function name: exits_description
  * Description  : This function will return the exits described in a nice way.
+ *                Unless the exits depend on VBFC, the text is kept until an
+ *                exit changes.
  * Returns      : string - the description.
  */
 public string
 exits_description()
 {
     string *exits;
-    int size;
     string text;
 
+    if (pointerp(exits_text_cache))
+    {
+        return exits_text_cache[0] +
+            (this_player()->query_wiz_level() ? exits_text_cache[1] : "");
+    }
+
     if (query_noshow_obvious())
     {
         exits = ({ });
@@ -142,40 +225,49 @@ exits_description()
         exits = query_obvious_exits();
     }
 
-    switch(size = sizeof(exits))
+    if (exits_describable())
     {
-    case 0:
-        text = "";
-        break;
-
-    case 1:
-        text =  "There is one obvious exit: " + exits[0] + ".\n";
-        break;
-
-    default:
-        text = "There are " + LANG_WNUM(size) +
-            " obvious exits: " + COMPOSITE_WORDS(exits) + ".\n";
+        exits_text_cache = ({ exits_text(exits, "obvious"),
+            exits_text(query_exit_cmds() - exits, "non-obvious") });
+        return exits_description();
     }
 
+    text = exits_text(exits, "obvious");
     if (this_player()->query_wiz_level())
     {
-        exits = query_exit_cmds() - exits;
-        switch(size  = sizeof(exits))
-        {
-        case 0:
-            break;
+        text += exits_text(query_exit_cmds() - exits, "non-obvious");
+    }
 
-        case 1:
-            text += "There is one non-obvious exit: " + exits[0] + ".\n";
-            break;
+    return text;
+}
 
-        default:
-            text += "There are " + LANG_WNUM(size) +
-               " non-obvious exits: " + COMPOSITE_WORDS(exits) + ".\n";
+/*
+ * Function name: compile_descs
+ * Description  : Prepare the extra descriptions for use in the long
+ *                description. Following plain texts are joined, while the
+ *                VBFC descriptions are kept to be evaluated each time.
+ */
+static void
+compile_descs()
+{
+    int index = -1;
+    int size = sizeof(room_descs);
+    int last;
+
+    room_descs_cache = ({ });
+    while((index += 2) < size)
+    {
+        last = sizeof(room_descs_cache) - 1;
+        if (is_plain_text(room_descs[index]) && (last >= 0) &&
+            is_plain_text(room_descs_cache[last]))
+        {
+            room_descs_cache[last] += room_descs[index];
+        }
+        else
+        {
+            room_descs_cache += ({ room_descs[index] });
         }
     }
-
-    return text;
 }
 
 /*
@@ -189,12 +281,19 @@ long(string item)
 {
     int index;
     int size;
-    string desc = ::long(item);
+    mixed desc;
 
     /* When querying for an item, just return the underlying desc. */
     if (stringp(item))
     {
-        return desc;
+        return ::long(item);
+    }
+
+    /* A plain long description need not be processed for VBFC. */
+    desc = query_long();
+    if (!is_plain_text(desc))
+    {
+        desc = ::long(item);
     }
 
     /* Initialize in case there isn't a long description (bad long). */
@@ -209,15 +308,24 @@ long(string item)
     while ((index = member_array(0, room_descs)) >= 0)
     {
         room_descs = exclude_array(room_descs, index, index + 1);
+        room_descs_cache = 0;
     }
 
     if (pointerp(room_descs))
     {
+        if (!pointerp(room_descs_cache))
+        {
+            compile_descs();
+        }
+
         index = -1;
-        size = sizeof(room_descs);
-        while((index += 2) < size)
+        size = sizeof(room_descs_cache);
+        while(++index < size)
         {
-            desc += check_call(room_descs[index]);
+            if (is_plain_text(room_descs_cache[index]))
+                desc += room_descs_cache[index];
+            else
+                desc += check_call(room_descs_cache[index]);
         }
     }
 
@@ -20,6 +20,22 @@ static int   room_no_obvious;
 static string *default_dirs = DEFAULT_DIRECTIONS;
 static mapping no_exit_messages;
 
+/*
+ * neighbour_cache - ({ mixed *exit rooms, string *door rooms }) the rooms
+ *                   this room leads to, as used by the neighbour search in
+ *                   CMDPARSE_STD. It is reset to 0 when an exit or door
+ *                   changes.
+ */
+static mixed  neighbour_cache;
+
+/*
+ * exits_text_cache - ({ string obvious, string non-obvious }) the lines
+ *                    about the exits in the long description, as made by
+ *                    exits_description(). It is reset to 0 when an exit
+ *                    changes.
+ */
+static mixed  exits_text_cache;
+
 /*
  * Prototype
  */
@@ -85,6 +101,7 @@ public void
 set_noshow_obvious(int obv)
 {
     room_no_obvious = obv;
+    exits_text_cache = 0;
 }
 
 /*
@@ -169,6 +186,8 @@ add_exit(string place, string cmd, mixed efunc, mixed tired, mixed non_obvious)
         non_obvious_exits[sizeof(non_obvious_exits) - 1] = non_obvious;
     }
 
+    neighbour_cache = 0;
+    exits_text_cache = 0;
     map(FILTER_LIVE(all_inventory()), &ugly_update_action(, cmd, unq_move));
     default_dirs -= ({ cmd });
     return 1;
@@ -207,6 +226,8 @@ remove_exit(string cmd)
             if (member_array(cmd, DEFAULT_DIRECTIONS) >= 0)
                 default_dirs += ({ cmd });
 
+            neighbour_cache = 0;
+            exits_text_cache = 0;
             map(FILTER_LIVE(all_inventory()), &ugly_update_action(, cmd, unq_no_move));
             return 1;
         }
@@ -477,6 +498,123 @@ query_no_exit_msg(string exit)
     return no_exit_messages[exit];
 }
 
+/*
+ * Function name: reset_neighbour_cache
+ * Description  : Forget the rooms this room leads to. Called when an exit
+ *                or door changes.
+ */
+public void
+reset_neighbour_cache()
+{
+    neighbour_cache = 0;
+}
+
+/*
+ * Function name: add_prop_room_ao_doorob
+ * Description  : When a door is added or removed, the rooms this room leads
+ *                to change.
+ * Arguments    : mixed val - the new list of doors.
+ * Returns      : int 0 - always allow the change.
+ */
+public int
+add_prop_room_ao_doorob(mixed val)
+{
+    neighbour_cache = 0;
+    return 0;
+}
+
+/*
+ * Function name: remove_prop_room_ao_doorob
+ * Description  : When the doors are removed, the rooms this room leads to
+ *                change.
+ * Returns      : int 0 - always allow the change.
+ */
+public int
+remove_prop_room_ao_doorob()
+{
+    neighbour_cache = 0;
+    return 0;
+}
+
+/*
+ * Function name: query_neighbour_rooms
+ * Description  : Find the rooms this room leads to. Exits with a function as
+ *                destination are left out. The result is cached until an
+ *                exit or a door changes, so don't alter it. When the room
+ *                redefines query_exit() or query_exit_rooms(), those are
+ *                asked every time instead.
+ * Returns      : mixed * - ({ mixed *exit rooms, string *door rooms }),
+ *                    the exit rooms being filenames or objects.
+ */
+public mixed *
+query_neighbour_rooms()
+{
+    mixed  *rooms;
+    mixed  *exits = ({ });
+    string *doors = ({ });
+    object *door_obs;
+    mixed  dest;
+    int    cacheable;
+    int    index;
+    int    size;
+
+    if (function_exists("query_exit_rooms", this_object()) != ROOM_OBJECT)
+    {
+        rooms = this_object()->query_exit_rooms();
+    }
+    else if (function_exists("query_exit", this_object()) != ROOM_OBJECT)
+    {
+        rooms = ({ });
+        dest = this_object()->query_exit();
+        index = -3;
+        size = sizeof(dest);
+        while((index += 3) < size)
+        {
+            rooms += ({ dest[index] });
+        }
+    }
+    else if (pointerp(neighbour_cache))
+    {
+        return neighbour_cache;
+    }
+    else
+    {
+        rooms = exit_data(0);
+        cacheable = 1;
+    }
+
+    index = -1;
+    size = sizeof(rooms);
+    while(++index < size)
+    {
+        dest = rooms[index];
+        if (!functionp(dest) &&
+            (member_array(dest, exits) < 0))
+        {
+            exits += ({ dest });
+        }
+    }
+
+    door_obs = query_prop(ROOM_AO_DOOROB);
+    index = -1;
+    size = sizeof(door_obs);
+    while(++index < size)
+    {
+        if (objectp(door_obs[index]) &&
+            stringp(dest = door_obs[index]->query_other_room()))
+        {
+            doors += ({ dest });
+        }
+    }
+
+    if (!cacheable)
+    {
+        return ({ exits, doors });
+    }
+
+    return (neighbour_cache = ({ exits, doors }));
+}
+
 /*
  * Function name: query_doors
  * Description  : Finds all door objects in this room.
@@ -34,8 +34,8 @@ public void burned_out();
 private int Torch_Value,	/* The max value of the torch. */
             Light_Strength,	/* How strongly the 'torch' will shine */
             Time_Left;		/* How much time is left? */
-static  int Burn_Alarm,		/* Alarm used when the torch is lit */
-            Decay_Alarm,        /* Alarm used when the torch decays */
+static  int Burn_Alarm,		/* Timer used when the torch is lit */
+            Decay_Alarm,        /* Timer used when the torch decays */
             Max_Time;		/* How much is the max time (start time) */
 
 /*
@@ -106,10 +106,11 @@ reset_object()
 public int
 query_time(int flag = 0)
 {
-    mixed alarm;
+    float left;
 
-    if (flag && Burn_Alarm && sizeof(alarm = get_alarm(Burn_Alarm)))
-	Time_Left = ftoi(alarm[2]);
+    if (flag && Burn_Alarm &&
+	((left = TIMER_WHEEL->query_timer_left(Burn_Alarm)) >= 0.0))
+	Time_Left = ftoi(left);
     return Time_Left;
 }
 
@@ -227,11 +228,11 @@ query_max_time()
 /*
  * Function name: query_lit
  * Description:   Query of the torch is lit.
- * Argument:      flag - if set, return id of the alarm to the function
- *                that is called when the torch burns out.
+ * Argument:      flag - if set, return id of the timer in the timer wheel
+ *                that calls the function when the torch burns out.
  * Returns:       0        - if torch is not lit,
  *                -1       - if torch is lit,
- *                alarm id - if torch is lit and flag was set.
+ *                timer id - if torch is lit and flag was set.
  */
 public int
 query_lit(int flag)
@@ -253,11 +254,11 @@ set_time_left(int left)
 {
     Time_Left = ((left < Max_Time) ? left : Max_Time);
 
-    /* If lit, then also update the alarm. */
+    /* If lit, then also update the timer. */
     if (Burn_Alarm)
     {
-	remove_alarm(Burn_Alarm);
-	Burn_Alarm = set_alarm(itof(Time_Left), 0.0, burned_out);
+	TIMER_WHEEL->remove_timer(Burn_Alarm);
+	Burn_Alarm = TIMER_WHEEL->add_timer(itof(Time_Left), burned_out);
     }
 }
 
@@ -323,7 +324,7 @@ light_me_after_delay()
     add_prop(OBJ_I_HAS_FIRE, 1);
     add_adj("lit");
     add_adj("burning");
-    Burn_Alarm = set_alarm(itof(Time_Left), 0.0, burned_out);
+    Burn_Alarm = TIMER_WHEEL->add_timer(itof(Time_Left), burned_out);
     return 1;
 }
 
@@ -401,17 +402,17 @@ command_light()
 int
 extinguish_me()
 {
-    mixed *alarm;
+    float left;
 
     if (!Burn_Alarm)
     {
         return 0;
     }
 
-    if (sizeof(alarm = get_alarm(Burn_Alarm)))
+    if ((left = TIMER_WHEEL->query_timer_left(Burn_Alarm)) >= 0.0)
     {
-	Time_Left = ftoi(get_alarm(Burn_Alarm)[2]);
-	remove_alarm(Burn_Alarm);
+	Time_Left = ftoi(left);
+	TIMER_WHEEL->remove_timer(Burn_Alarm);
     }
 
     Burn_Alarm = 0;
@@ -518,7 +519,7 @@ burned_out()
 
         if (query_torch_may_decay())
         {
-            Decay_Alarm = set_alarm(DECAY_TIME, 0.0, decay_torch);
+            Decay_Alarm = TIMER_WHEEL->add_timer(DECAY_TIME, decay_torch);
         }
     }
 
@@ -547,13 +548,13 @@ enter_env(object to, object from)
             /* Don't bother to keep track of the decay time it has already
              * had. When it is dropped again, simply start counting anew.
              */
-            remove_alarm(Decay_Alarm);
+            TIMER_WHEEL->remove_timer(Decay_Alarm);
             Decay_Alarm = 0;
         }
     }
     else if (!Time_Left && query_torch_may_decay())
     {
-        Decay_Alarm = set_alarm(DECAY_TIME, 0.0, decay_torch);
+        Decay_Alarm = TIMER_WHEEL->add_timer(DECAY_TIME, decay_torch);
     }
 }
 
@@ -565,11 +566,13 @@ enter_env(object to, object from)
 public string
 query_torch_recover()
 {
+    float left;
     int tmp;
 
-    if (Burn_Alarm && sizeof(get_alarm(Burn_Alarm)))
+    if (Burn_Alarm &&
+	((left = TIMER_WHEEL->query_timer_left(Burn_Alarm)) >= 0.0))
     {
-	tmp = ftoi(get_alarm(Burn_Alarm)[2]);
+	tmp = ftoi(left);
     }
     else
     {
@@ -597,7 +600,7 @@ init_torch_recover(string arg)
     {
 	add_prop(OBJ_I_LIGHT, tmp);
 	add_prop(OBJ_I_HAS_FIRE, 1);
-	Burn_Alarm = set_alarm(itof(Time_Left), 0.0, burned_out);
+	Burn_Alarm = TIMER_WHEEL->add_timer(itof(Time_Left), burned_out);
     }
 }
 
@@ -360,6 +360,15 @@
 #define FIND_NEIGHBOURS_SELF(search, depth) \
     (object *)CMDPARSE_STD->find_neighbours(search, depth, 1)
 
+/*
+ * FIND_NEIGHBOUR_DISTANCES(search, radius)
+ *
+ * Returns a mapping ([ room : steps ]) with the rooms within 'radius' steps
+ * of the 'search' room or rooms, and the number of steps to each of them.
+ */
+#define FIND_NEIGHBOUR_DISTANCES(search, radius) \
+    (mapping)CMDPARSE_STD->find_neighbour_distances(search, radius)
+
 /*
  * Fix to get rid of the obnoxius 'What ?' when we try to walk in a nonexistant
  * direction. These are the default direction commands.
@@ -78,6 +78,7 @@
 #define LOGIN_OBJECT       ("/secure/login")
 #define MAIL_CHECKER       ("/secure/mail_checker")
 #define MAIL_READER        ("/secure/mail_reader")
+#define MAIL_SPOOL         ("/secure/mail_spool")
 #define MAP_CENTRAL        ("/secure/map_central")
 #define MSSP               ("/secure/mssp")
 #define PLAYER_TOOL        ("/secure/player_tool")
@@ -139,6 +140,10 @@
 #define WORKROOM_OBJECT    ("/std/workroom")
 
 /* The section /sys */
+#define COMBAT_CLOCK       ("/sys/global/combat_clock")
+#define TIMER_WHEEL        ("/sys/global/timer_wheel")
+#define CONTAINER_FLUSH    ("/sys/global/container_flush")
+#define SOUL_INDEX         ("/sys/global/soul_index")
 #define MANCTRL            ("/sys/global/manpath")
 #define FPATH_FILENAME     ("/sys/global/filepath")
 #define LISTENER_CENTRAL   ("/sys/global/listeners")
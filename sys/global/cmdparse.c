@@ -573,73 +573,87 @@ paralyze_cmd_is_allowed(string cmd)
 }
 
 /*
- * Function name: recurse_neighbours
- * Description  : This function will recursively search through the
- *                neighbouring rooms to a particular room to find the
- *                rooms a shout or scream will be heard in.
+ * Function name: walk_neighbours
+ * Description  : Walk breadth first through the neighbouring rooms of the
+ *                rooms to search. Rooms reached through an exit are
+ *                searched further, rooms on the other side of a door are
+ *                not. The rooms each room leads to are cached in the room.
  * Arguments    : object *found  - the rooms already found.
  *                object *search - the rooms still to search.
  *                int    depth   - the depth still to search.
- * Returns      : object * - the neighbouring rooms (which will contain the
- *                    original rooms for depth > 1).
+ *                mapping dist   - if a mapping, it is filled with the
+ *                                 distance to each room newly found.
+ * Returns      : object * - the found rooms in the order found.
  */
-object *
-recurse_neighbours(object *found, object *search, int depth)
+static object *
+walk_neighbours(object *found, object *search, int depth, mapping dist)
 {
-    int index;
-    int size;
-    int index2;
-    int size2;
-    mixed *exit_arr;
-    object *new_search, *rooms, troom, *doors;
-
-    if (!depth)
+    mapping seen = ([ ]);
+    mixed  *adjacent;
+    object *new_search, troom;
+    int    level;
+
+    foreach(object room: found)
     {
-        return found;
+        seen[room] = 1;
     }
 
-    rooms = found;
-    new_search = ({ });
-
-    index = -1;
-    size = sizeof(search);
-    while(++index < size)
+    while((++level <= depth) && sizeof(search))
     {
-        exit_arr = (mixed *)search[index]->query_exit();
-
-        index2 = -3;
-        size2 = sizeof(exit_arr);
-        while((index2 += 3) < size2)
+        new_search = ({ });
+        foreach(object room: search)
         {
-            if (functionp(exit_arr[index2]))
-                continue;
-            if (objectp(exit_arr[index2]))
-                troom = exit_arr[index2];
-            else
-                troom = find_object(exit_arr[index2]);
-            if (objectp(troom) &&
-                (member_array(troom, rooms) < 0))
+            if (!objectp(room) ||
+                !pointerp(adjacent = room->query_neighbour_rooms()))
             {
-                rooms += ({ troom });
-                new_search += ({ troom });
+                continue;
             }
-        }
 
-        doors = search[index]->query_prop(ROOM_AO_DOOROB);
+            foreach(mixed dest: adjacent[0])
+            {
+                troom = (objectp(dest) ? dest : find_object(dest));
+                if (objectp(troom) && !seen[troom])
+                {
+                    seen[troom] = 1;
+                    found += ({ troom });
+                    new_search += ({ troom });
+                    if (mappingp(dist))
+                        dist[troom] = level;
+                }
+            }
 
-        index2 = -1;
-        size2 = sizeof(doors);
-        while (++index2 < size2)
-        {
-            if (objectp(troom = find_object(doors[index2]->query_other_room())) &&
-                member_array(troom, rooms) < 0)
+            foreach(string dest: adjacent[1])
             {
-                rooms += ({ troom });
+                if (objectp(troom = find_object(dest)) && !seen[troom])
+                {
+                    seen[troom] = 1;
+                    found += ({ troom });
+                    if (mappingp(dist))
+                        dist[troom] = level;
+                }
             }
         }
+        search = new_search;
     }
 
-    return recurse_neighbours(rooms, new_search, depth - 1);
+    return found;
+}
+
+/*
+ * Function name: recurse_neighbours
+ * Description  : This function will search through the neighbouring rooms
+ *                to a particular room to find the rooms a shout or scream
+ *                will be heard in.
+ * Arguments    : object *found  - the rooms already found.
+ *                object *search - the rooms still to search.
+ *                int    depth   - the depth still to search.
+ * Returns      : object * - the neighbouring rooms (which will contain the
+ *                    original rooms for depth > 1).
+ */
+object *
+recurse_neighbours(object *found, object *search, int depth)
+{
+    return walk_neighbours(found, search, depth, 0);
 }
 
 /*
@@ -659,7 +673,30 @@ find_neighbours(object *search, int depth = 1, int with_seed = 0)
 
     if (!pointerp(search)) { search = ({ search }); }
 
-    results = recurse_neighbours( ({ }), search, depth);
+    results = walk_neighbours( ({ }), search, depth, 0);
 
     return with_seed ? results : (results - search);
 }
+
+/*
+ * Function name: find_neighbour_distances
+ * Description  : Find the rooms within a certain radius of one or more
+ *                rooms, with the number of steps it takes to get there.
+ *                Rooms on the other side of a door are one step away,
+ *                but are not searched further.
+ * Arguments    : mixed search - the room or rooms to start from.
+ *                int radius   - the number of steps to search.
+ * Returns      : mapping - ([ object room : int steps ]). A seed room is
+ *                    only included when it can be reached again.
+ */
+mapping
+find_neighbour_distances(mixed search, int radius = 1)
+{
+    mapping dist = ([ ]);
+
+    if (!pointerp(search)) { search = ({ search }); }
+
+    walk_neighbours( ({ }), search, radius, dist);
+
+    return dist;
+}
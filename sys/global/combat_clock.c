@@ -0,0 +1,382 @@
+/*
+ * /sys/global/combat_clock.c
+ *
+ * This is the central combat scheduler. Instead of every combat object
+ * running its own repeating alarm for its combat rounds, the combat objects
+ * register themselves with this clock. The clock groups the combatants into
+ * buckets by the time their next round is due and runs all rounds in a
+ * bucket from a single alarm. Only one alarm is ever pending in this object,
+ * armed for the earliest bucket.
+ *
+ * Each combatant keeps its own cadence. When the round of a combatant is
+ * run, its next round is due exactly one combat speed after the previous
+ * one was due, so the rounds do not drift even though the buckets are
+ * coarse. A change of speed is a matter of moving the combatant to another
+ * bucket.
+ *
+ * The interface is used by /std/combat/cbase.c only:
+ *
+ *     void schedule(float speed)        - start the rounds of the caller.
+ *     void reschedule(float speed)      - change the speed of the caller.
+ *     void unschedule()                 - stop the rounds of the caller.
+ *     int  query_scheduled(object ob)   - is the combat object scheduled.
+ *
+ * The clock calls cb_clock_round() in the combat object for each round.
+ * When the clock is destructed, for instance to update it, it calls
+ * cb_clock_removed() in each combat object, so that it can register with
+ * the new clock.
+ *
+ * The rounds are not run within a catch, so a runtime error is reported by
+ * the driver with its full trace, like it was from the alarm of the combat
+ * object. A continuation alarm is set before the rounds are run, so that
+ * the other rounds of the bucket are run even when one fails.
+ */
+
+#pragma no_clone
+#pragma no_inherit
+#pragma save_binary
+#pragma strict_types
+
+#include <std.h>
+
+/*
+ * CLOCK_QUANTUM       - the width of a bucket in seconds.
+ * CLOCK_MAX_PER_TICK  - the maximum number of rounds run from one alarm. The
+ *                       rest is continued in a fresh execution so that a
+ *                       big fight does not run into the evaluation limit.
+ * CLOCK_MAX_TICK_TIME - the time in seconds after which no more rounds are
+ *                       started from the same alarm, for rounds that are
+ *                       heavy, like those with spells or deaths.
+ */
+#define CLOCK_QUANTUM       (0.25)
+#define CLOCK_MAX_PER_TICK  (8)
+#define CLOCK_MAX_TICK_TIME (0.02)
+
+#define REC_DUE   0
+#define REC_SPEED 1
+
+/*
+ * Global variables. They are private since no one should mess with them.
+ *
+ * combatants - ([ object combat object : ({ float due, float speed }) ])
+ * buckets    - ([ int slot : ([ object combat object : 1 ]) ])
+ */
+private static mapping combatants = ([ ]);
+private static mapping buckets = ([ ]);
+private static float   epoch;
+private static int     tick_alarm;
+private static int     tick_slot;
+private static int     rounds_run;
+private static int     ticks_run;
+
+/*
+ * Prototypes.
+ */
+static void tick();
+
+/*
+ * Function name: create
+ * Description  : Constructor. Marks the epoch relative to which all times
+ *                in the clock are computed. This keeps the slot numbers
+ *                small.
+ */
+public void
+create()
+{
+    setuid();
+    seteuid(getuid());
+
+    epoch = gettimeofday();
+}
+
+/*
+ * Function name: clock_now
+ * Description  : Find out the current time relative to the epoch.
+ * Returns      : float - the time in seconds.
+ */
+static float
+clock_now()
+{
+    return gettimeofday() - epoch;
+}
+
+/*
+ * Function name: time_to_slot
+ * Description  : Find the bucket in which a round is due. We round up so
+ *                that a round is never run before it is due.
+ * Arguments    : float due - the time the round is due.
+ * Returns      : int - the bucket slot.
+ */
+static int
+time_to_slot(float due)
+{
+    return ftoi(due / CLOCK_QUANTUM) + 1;
+}
+
+/*
+ * Function name: arm_alarm
+ * Description  : Make sure the alarm is set for the given slot, if it is
+ *                earlier than the slot the alarm is currently set for.
+ * Arguments    : int slot - the slot that must be ticked.
+ */
+static void
+arm_alarm(int slot)
+{
+    if (tick_alarm && (tick_slot <= slot))
+    {
+        return;
+    }
+
+    remove_alarm(tick_alarm);
+    tick_slot = slot;
+    tick_alarm = set_alarm(max(0.0, itof(slot) * CLOCK_QUANTUM - clock_now()),
+        0.0, tick);
+}
+
+/*
+ * Function name: add_to_bucket
+ * Description  : Register the next round of a combat object.
+ * Arguments    : object ob - the combat object.
+ *                float due - the time the next round is due.
+ *                float speed - the combat speed of the object.
+ */
+static void
+add_to_bucket(object ob, float due, float speed)
+{
+    int slot = time_to_slot(due);
+
+    combatants[ob] = ({ due, speed });
+    if (!mappingp(buckets[slot]))
+    {
+        buckets[slot] = ([ ]);
+    }
+    buckets[slot][ob] = 1;
+
+    arm_alarm(slot);
+}
+
+/*
+ * Function name: remove_from_bucket
+ * Description  : Remove the pending round of a combat object.
+ * Arguments    : object ob - the combat object.
+ */
+static void
+remove_from_bucket(object ob)
+{
+    mixed rec;
+    int slot;
+
+    if (!pointerp(rec = combatants[ob]))
+    {
+        return;
+    }
+
+    slot = time_to_slot(rec[REC_DUE]);
+    if (mappingp(buckets[slot]))
+    {
+        m_delkey(buckets[slot], ob);
+        if (!m_sizeof(buckets[slot]))
+        {
+            m_delkey(buckets, slot);
+        }
+    }
+    m_delkey(combatants, ob);
+}
+
+/*
+ * Function name: schedule
+ * Description  : Called from a combat object to start its combat rounds.
+ *                The first round is due after one round of time. If the
+ *                object is already scheduled, nothing happens.
+ * Arguments    : float speed - the number of seconds between rounds.
+ */
+public void
+schedule(float speed)
+{
+    object ob = previous_object();
+
+    if (pointerp(combatants[ob]))
+    {
+        return;
+    }
+
+    add_to_bucket(ob, clock_now() + speed, speed);
+}
+
+/*
+ * Function name: reschedule
+ * Description  : Called from a combat object when its speed changed. The
+ *                remaining time until the next round is scaled to the new
+ *                speed, like it would be for a running alarm.
+ * Arguments    : float speed - the new number of seconds between rounds.
+ */
+public void
+reschedule(float speed)
+{
+    object ob = previous_object();
+    mixed rec;
+    float now, left;
+
+    if (!pointerp(rec = combatants[ob]) ||
+        (rec[REC_SPEED] == speed))
+    {
+        return;
+    }
+
+    now = clock_now();
+    left = max(0.0, rec[REC_DUE] - now);
+    remove_from_bucket(ob);
+    add_to_bucket(ob, now + speed * (left / rec[REC_SPEED]), speed);
+}
+
+/*
+ * Function name: unschedule
+ * Description  : Called from a combat object to stop its combat rounds.
+ */
+public void
+unschedule()
+{
+    remove_from_bucket(previous_object());
+}
+
+/*
+ * Function name: query_scheduled
+ * Description  : Find out whether a combat object has its rounds running.
+ * Arguments    : object ob - the combat object.
+ * Returns      : int 1/0 - scheduled or not.
+ */
+public int
+query_scheduled(object ob)
+{
+    return pointerp(combatants[ob]);
+}
+
+/*
+ * Function name: tick
+ * Description  : Called from the alarm. Runs the rounds of all combatants
+ *                in all buckets that are due. Before the round of each
+ *                combatant is run, its next round is registered, so that
+ *                the combat object may stop or change it from within its
+ *                round.
+ */
+static void
+tick()
+{
+    int *slots, now_slot, count;
+    float now, due, start;
+    mixed rec;
+
+    ticks_run++;
+    start = gettimeofday();
+    now = start - epoch;
+    /* The alarm may fire a hair early, so always run the slot it was for. */
+    now_slot = max(time_to_slot(now) - 1, tick_slot);
+
+    /* Keep the rest for a fresh execution, also when a round fails. */
+    remove_alarm(tick_alarm);
+    tick_slot = now_slot;
+    tick_alarm = set_alarm(0.0, 0.0, tick);
+
+    slots = sort_array(filter(m_indexes(buckets),
+        &operator(>=)(now_slot, )));
+
+    foreach(int slot: slots)
+    {
+        foreach(object ob: m_indexes(buckets[slot]))
+        {
+            if ((count >= CLOCK_MAX_PER_TICK) ||
+                ((gettimeofday() - start) > CLOCK_MAX_TICK_TIME))
+            {
+                return;
+            }
+
+            m_delkey(buckets[slot], ob);
+            if (!objectp(ob))
+            {
+                continue;
+            }
+            if (!pointerp(rec = combatants[ob]))
+            {
+                continue;
+            }
+
+            /* The next round is due one speed after this one was. */
+            due = rec[REC_DUE] + rec[REC_SPEED];
+            if (due < now)
+            {
+                due = now + rec[REC_SPEED];
+            }
+            m_delkey(combatants, ob);
+            add_to_bucket(ob, due, rec[REC_SPEED]);
+
+            count++;
+            rounds_run++;
+            ob->cb_clock_round();
+        }
+
+        if (mappingp(buckets[slot]) && !m_sizeof(buckets[slot]))
+        {
+            m_delkey(buckets, slot);
+        }
+    }
+
+    /* Clean out the combat objects that were destructed. */
+    m_delkey(combatants, 0);
+
+    /* Make sure we are armed for the earliest remaining bucket. */
+    remove_alarm(tick_alarm);
+    tick_alarm = 0;
+    if (m_sizeof(buckets))
+    {
+        arm_alarm(sort_array(m_indexes(buckets))[0]);
+    }
+}
+
+/*
+ * Function name: query_combatants
+ * Description  : Find out which combat objects are scheduled.
+ * Returns      : object * - the combat objects.
+ */
+public object *
+query_combatants()
+{
+    return m_indexes(combatants) - ({ 0 });
+}
+
+/*
+ * Function name: query_stats
+ * Description  : Some statistics on the operation of the clock.
+ * Returns      : mapping - the statistics.
+ */
+public mapping
+query_stats()
+{
+    return ([ "combatants" : m_sizeof(combatants),
+              "buckets"    : m_sizeof(buckets),
+              "ticks"      : ticks_run,
+              "rounds"     : rounds_run ]);
+}
+
+/*
+ * Function name: remove_object
+ * Description  : Destruct the clock. The running fights are handed over to
+ *                the new clock, since their rounds would stop with us.
+ *                Each combat object is told when its next round was due,
+ *                and registers with the new clock at that time.
+ */
+public int
+remove_object()
+{
+    float now = clock_now();
+
+    foreach(object ob, mixed rec: combatants)
+    {
+        if (objectp(ob))
+        {
+            catch(ob->cb_clock_removed(max(0.0, rec[REC_DUE] - now)));
+        }
+    }
+
+    destruct();
+    return 1;
+}
@@ -4,12 +4,32 @@
 #pragma save_binary
 #pragma strict_types
 
+#include <files.h>
 #include <language.h>
 #include <options.h>
+#include <ss_types.h>
 #include <stdproperties.h>
 
+/*
+ * The descriptions of the dead objects in a container are kept per class of
+ * viewer, i.e. the things that decide what the viewer can see. A kept
+ * description is used as long as the same objects are described and the
+ * description stamp of the container did not change.
+ *
+ * desc_memo = ([ object container : ([ string class : ({ stamp, objects,
+ *                shown objects, cacheable, description }) ]) ])
+ */
+#define MEMO_STAMP   0
+#define MEMO_ARRAY   1
+#define MEMO_SHOWN   2
+#define MEMO_OK      3
+#define MEMO_TEXT    4
+#define MEMO_MAX     (500)   /* Containers kept.             */
+#define MEMO_CLASSES (20)    /* Viewer classes per container. */
+
 object *extra = ({});
 mixed *OldArr = ({});
+static mapping desc_memo = ([ ]);
 /*
  *  Prototypes
  */
@@ -20,10 +40,140 @@ string lpc_describe(mixed *uarr, function dfun, object for_obj);
 varargs string composite_words(string *wlist, string word);
 
 
+/*
+ * Function name: viewer_class
+ * Description  : Find the class of a viewer, i.e. what decides which objects
+ *                he or she can see.
+ * Arguments    : object for_obj - the viewer.
+ * Returns      : string - the class.
+ */
+static string
+viewer_class(object for_obj)
+{
+    if (for_obj->query_wiz_level())
+    {
+        return "wizard";
+    }
+
+    return for_obj->query_prop(LIVE_I_SEE_INVIS) + ":" +
+        for_obj->query_skill(SS_AWARENESS);
+}
+
+/*
+ * Function name: memo_cacheable
+ * Description  : Find out whether the description of an object is the same
+ *                for all viewers of a class, as long as it stays where it
+ *                is. This is true for dead objects with a plain short
+ *                description that do not decide themselves who sees them.
+ * Arguments    : object ob - the object to test.
+ *                object env - the container it should be in.
+ * Returns      : int 1/0 - cacheable or not.
+ */
+static int
+memo_cacheable(object ob, object env)
+{
+    mixed desc;
+
+    if ((environment(ob) != env) || living(ob) ||
+        (function_exists("short", ob) != OBJECT_OBJECT) ||
+        (function_exists("plural_short", ob) != OBJECT_OBJECT) ||
+        (function_exists("check_seen", ob) != OBJECT_OBJECT))
+    {
+        return 0;
+    }
+
+    desc = ob->query_short();
+    if (!stringp(desc) || wildmatch("*@@*", desc))
+    {
+        return 0;
+    }
+
+    desc = ob->query_plural_short();
+    return (!desc || (stringp(desc) && !wildmatch("*@@*", desc)));
+}
+
+/*
+ * Function name: same_objects
+ * Description  : See whether two arrays hold the same objects in the same
+ *                order.
+ * Arguments    : object *a, *b - the arrays.
+ * Returns      : int 1/0 - the same or not.
+ */
+static int
+same_objects(object *a, object *b)
+{
+    int index = sizeof(a);
+
+    if (index != sizeof(b))
+    {
+        return 0;
+    }
+
+    while(--index >= 0)
+    {
+        if (a[index] != b[index])
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 static varargs string
 desc_live_dead(mixed arr, object for_obj, int include_no_show)
 {
-    return composite(arr, "short", desc_same, for_obj, include_no_show);
+    object env;
+    string key;
+    mixed  memo;
+    int    stamp;
+    int    ok;
+    string text;
+
+    if (objectp(arr))
+    {
+        arr = ({ arr });
+    }
+
+    /* Only the contents of a container can be kept. */
+    if (!objectp(for_obj) || !sizeof(arr) || !objectp(arr[0]) ||
+        !objectp(env = environment(arr[0])) ||
+        !(stamp = env->query_desc_stamp()))
+    {
+        return composite(arr, "short", desc_same, for_obj, include_no_show);
+    }
+
+    key = viewer_class(for_obj) + (include_no_show ? ":all" : "");
+    if (mappingp(desc_memo[env]) &&
+        pointerp(memo = desc_memo[env][key]) &&
+        (memo[MEMO_STAMP] == stamp) &&
+        same_objects(memo[MEMO_ARRAY], arr))
+    {
+        if (memo[MEMO_OK])
+        {
+            OldArr = memo[MEMO_SHOWN];
+            return memo[MEMO_TEXT];
+        }
+
+        return composite(arr, "short", desc_same, for_obj, include_no_show);
+    }
+
+    text = composite(arr, "short", desc_same, for_obj, include_no_show);
+    ok = (sizeof(filter(arr, &memo_cacheable(, env))) == sizeof(arr));
+
+    if (m_sizeof(desc_memo) >= MEMO_MAX)
+    {
+        desc_memo = ([ ]);
+    }
+    if (!mappingp(desc_memo[env]) ||
+        (m_sizeof(desc_memo[env]) >= MEMO_CLASSES))
+    {
+        desc_memo[env] = ([ ]);
+    }
+    desc_memo[env][key] = ({ env->query_desc_stamp(), arr + ({ }), OldArr,
+        ok, text });
+
+    return text;
 }
 
 varargs string
@@ -0,0 +1,130 @@
+/*
+ * /sys/global/container_flush.c
+ *
+ * Containers do not pass changes in light, weight and volume on to their
+ * environment immediately, but collect them until the end of the
+ * evaluation. See update_internal() in /std/container.c.
+ *
+ * Instead of every container with pending changes keeping its own alarm in
+ * the driver, the containers register themselves here. Only one alarm is
+ * ever pending in this object, and when it goes off, all containers that
+ * registered are flushed in one go.
+ *
+ * The interface:
+ *
+ *     void add_container() - flush the caller at the end of the evaluation.
+ */
+
+#pragma no_clone
+#pragma no_inherit
+#pragma save_binary
+#pragma strict_types
+
+#include <std.h>
+
+/*
+ * Global variables. They are private since no one should mess with them.
+ *
+ * dirty - ([ object container : 1 ]) the containers to flush.
+ */
+private static mapping dirty = ([ ]);
+private static int     flush_alarm;
+private static int     flushes_run;
+private static int     containers_flushed;
+
+/*
+ * Prototypes.
+ */
+static void flush_containers();
+
+/*
+ * Function name: create
+ * Description  : Constructor.
+ */
+public void
+create()
+{
+    setuid();
+    seteuid(getuid());
+}
+
+/*
+ * Function name: add_container
+ * Description  : Called from a container when it has changes pending for
+ *                its environment. The container is flushed at the end of
+ *                the evaluation, unless it was flushed by then.
+ */
+public void
+add_container()
+{
+    dirty[previous_object()] = 1;
+
+    if (!flush_alarm)
+    {
+        flush_alarm = set_alarm(0.0, 0.0, flush_containers);
+    }
+}
+
+/*
+ * Function name: flush_containers
+ * Description  : Called from the alarm to flush all containers that
+ *                registered. A container may register its environment while
+ *                it is flushed, so keep going until no one is left.
+ */
+static void
+flush_containers()
+{
+    object *obs;
+    string error;
+
+    flush_alarm = 0;
+    flushes_run++;
+
+    while (m_sizeof(dirty))
+    {
+        obs = m_indexes(dirty);
+        dirty = ([ ]);
+        containers_flushed += sizeof(obs);
+
+        foreach(object ob: obs)
+        {
+            /* One broken container must not keep the others dirty. */
+            if (objectp(ob) &&
+                (error = catch(ob->flush_internal())))
+            {
+                log_file("CONTAINER_FLUSH", ctime(time()) + " " +
+                    file_name(ob) + ": " + error, 1000000);
+            }
+        }
+    }
+
+    /* The flush itself may have armed the alarm again. */
+    remove_alarm(flush_alarm);
+    flush_alarm = 0;
+}
+
+/*
+ * Function name: query_stats
+ * Description  : Some statistics on the operation of the flush list.
+ * Returns      : mapping - the statistics.
+ */
+public mapping
+query_stats()
+{
+    return ([ "pending" : m_sizeof(dirty),
+              "flushes" : flushes_run,
+              "flushed" : containers_flushed ]);
+}
+
+/*
+ * Function name: remove_object
+ * Description  : Flush the pending containers before we go, since they
+ *                would never be flushed otherwise.
+ */
+public int
+remove_object()
+{
+    flush_containers();
+    destruct();
+    return 1;
+}
@@ -14,6 +14,16 @@
  * following routine for each newly cloned object.
  *
  *    (void) notify_new_object(object obj)
+ *
+ * A listener may pass a filter when it registers, so that it is only
+ * called for the objects it is interested in. The filter is either the
+ * filename of a program, in which case only objects of that program or
+ * that inherit it are passed, or a function that is called with the new
+ * object and returns true for relevant objects.
+ *
+ * The new objects are queued in chunks and processed from an alarm. Only
+ * a limited number of notifications is done per alarm, so that a burst of
+ * new objects during boot or a reset is spread out over a few alarms.
  */
 
 #pragma strict_types
@@ -22,10 +32,19 @@
 
 #include <macros.h>
 
+// Definitions
+#define CHUNK_SIZE      (100)   /* Objects per chunk of the queue.        */
+#define PROCESS_BUDGET  (500)   /* Notifications per alarm.               */
+#define PROCESS_DELAY   (1.0)   /* Delay before new objects are handled.  */
+
 // Global Variables
 public function *       listeners = ({ });
-public object *         waiting_objects = ({ });
+public mixed *          listener_filters = ({ });
+public mapping          waiting_chunks = ([ ]);
+public int              chunk_head = 0;
+public int              chunk_tail = 0;
 public int              process_alarm = 0;
+static mapping          program_inherits = ([ ]);
 
 // Prototypes
 public void             process_objects();
@@ -41,35 +60,102 @@ create()
     seteuid(getuid());
 }
 
+/*
+ * Function Name: clean_program
+ * Description  : Make a program name uniform, without leading slash and
+ *                without the .c suffix.
+ * Arguments    : string program - the name of the program.
+ * Returns      : string - the uniform name.
+ */
+static string
+clean_program(string program)
+{
+    if (wildmatch("/*", program))
+    {
+        program = program[1..];
+    }
+    if (wildmatch("*.c", program))
+    {
+        program = program[..-3];
+    }
+    return program;
+}
+
+/*
+ * Function Name: find_listener
+ * Description  : Find the listener object that wants to register.
+ * Arguments    : mixed listener - the object or its filename.
+ * Returns      : object - the listener object, or 0.
+ */
+static object
+find_listener(mixed listener)
+{
+    if (objectp(listener))
+    {
+        return listener;
+    }
+    if (stringp(listener))
+    {
+        return find_object(listener);
+    }
+    return 0;
+}
+
+/*
+ * Function Name: remove_listener
+ * Description  : Remove a listener function and its filter, as well as
+ *                the listeners that were destructed.
+ * Arguments    : function listener_fun - the function to remove.
+ */
+static void
+remove_listener(function listener_fun)
+{
+    int index = sizeof(listeners);
+
+    while (--index >= 0)
+    {
+        if (!listeners[index] || (listeners[index] == listener_fun))
+        {
+            listeners = exclude_array(listeners, index, index);
+            listener_filters = exclude_array(listener_filters, index, index);
+        }
+    }
+}
+
 /*
  * Function Name: register_listener
  * Description  : A listener who wants to be notified whenever a new
  *                object is cloned will register themselves here.
+ * Arguments    : mixed listener - the listener object or its filename.
+ *                mixed filter - optional, the filename of the program the
+ *                    new objects must be or inherit, or a function that
+ *                    returns true for the objects to pass.
  * Macro call   : LISTENER_ADD(obj) in <files.h>
  */
-public int
-register_listener(mixed listener)
+public varargs int
+register_listener(mixed listener, mixed filter)
 {
-    object listener_obj;
+    object listener_obj = find_listener(listener);
     function listener_fun;
 
-    if (objectp(listener))
+    if (!objectp(listener_obj))
     {
-        listener_obj = listener;
+        return 0;
     }
-    else if (stringp(listener) && objectp(find_object(listener)))
+
+    if (stringp(filter))
     {
-        listener_obj = find_object(listener);
+        filter = clean_program(filter);
     }
-
-    if (!objectp(listener_obj))
+    else if (!functionp(filter))
     {
-        return 0;
+        filter = 0;
     }
 
     listener_fun = listener_obj->notify_new_object;
-    listeners -= ({ listener_fun, 0 });
+    remove_listener(listener_fun);
     listeners += ({ listener_fun });
+    listener_filters += ({ filter });
     return 1;
 }
 
@@ -81,97 +167,179 @@ register_listener(mixed listener)
 public int
 unregister_listener(mixed listener)
 {
-    object listener_obj;
-    function listener_fun;
+    object listener_obj = find_listener(listener);
 
-    if (objectp(listener))
+    if (!objectp(listener_obj))
+    {
+        return 0;
+    }
+
+    remove_listener(listener_obj->notify_new_object);
+    return 1;    
+}
+
+/*
+ * Function Name: query_inherits
+ * Description  : Find the programs an object is made of. This is cached
+ *                per program, since the clones of a program all share it.
+ * Arguments    : object obj - the object to check.
+ * Returns      : string * - the uniform names of the programs.
+ */
+static string *
+query_inherits(object obj)
+{
+    string program = clean_program(MASTER_OB(obj));
+    string *inherits;
+
+    if (pointerp(inherits = program_inherits[program]))
     {
-        listener_obj = listener;
+        return inherits;
     }
-    else if (stringp(listener))
+
+    inherits = inherit_list(obj);
+    inherits = (pointerp(inherits) ? map(inherits, clean_program) : ({ }));
+    inherits |= ({ program });
+    program_inherits[program] = inherits;
+    return inherits;
+}
+
+/*
+ * Function Name: pass_filter
+ * Description  : See whether an object passes the filter of a listener.
+ * Arguments    : mixed filter - the filter.
+ *                object obj - the new object.
+ * Returns      : int 1/0 - pass or not.
+ */
+static int
+pass_filter(mixed filter, object obj)
+{
+    int result;
+
+    if (stringp(filter))
     {
-        listener_obj = find_object(listener);
+        return (member_array(filter, query_inherits(obj)) != -1);
     }
 
-    if (!objectp(listener_obj))
+    if (functionp(filter))
     {
-        return 0;
+        if (catch(result = filter(obj)))
+        {
+            return 0;
+        }
+        return result;
     }
 
-    listener_fun = listener_obj->notify_new_object;
-    listeners -= ({ listener_fun, 0 });
-    return 1;    
+    return 1;
 }
 
 /*
  * Function name: process_objects
- * Description:   This gets called every second to process all of
- *                the waiting objects. It loops through the listeners
- *                and processes them all.
+ * Description:   This gets called from an alarm to process the waiting
+ *                objects, a chunk at a time. Each object is passed to
+ *                each listener that accepts it. When the budget for this
+ *                alarm is spent, the rest is left for the next alarm.
  */
 public void
 process_objects()
 {
-    // Since this function is called in an alarm, we first copy
-    // all the objects to be processed to a local variable. That
-    // way there should be no race conditions.
-    object * local_waiting_objects = waiting_objects + ({ });
-    
-    waiting_objects = ({ });
+    object * chunk;
+    function fListener;
+    int nBudget = PROCESS_BUDGET;
+
     process_alarm = 0;
 
     // Validate the listeners first
-    listeners -= ({ 0 }); // remove invalid listeners
-    // Validate the waiting objects
-    local_waiting_objects -= ({ 0 }); // remove empty/invalid objects
-
-    int nNumObjects = sizeof(local_waiting_objects);
+    remove_listener(0);
     int nNumListeners = sizeof(listeners);
-    for (int nCurrentListenerIndex = 0; nCurrentListenerIndex < nNumListeners; ++nCurrentListenerIndex)
+
+    while ((chunk_head < chunk_tail) && (nBudget > 0))
     {
-        function fListener = listeners[nCurrentListenerIndex];
-        for (int nCurrentObjIndex = 0; nCurrentObjIndex < nNumObjects; ++nCurrentObjIndex)
+        // Take the chunk out of the queue first, so that objects that are
+        // cloned by the listeners end up in a new chunk.
+        chunk = waiting_chunks[chunk_head];
+        m_delkey(waiting_chunks, chunk_head);
+        chunk_head++;
+
+        int nNumObjects = sizeof(chunk);
+        int nCurrentObjIndex = 0;
+        for (; (nCurrentObjIndex < nNumObjects) && (nBudget > 0); ++nCurrentObjIndex)
         {
-            catch(fListener(local_waiting_objects[nCurrentObjIndex]));
+            object obj = chunk[nCurrentObjIndex];
+            if (!objectp(obj))
+            {
+                continue;
+            }
+
+            for (int nCurrentListenerIndex = 0; nCurrentListenerIndex < nNumListeners; ++nCurrentListenerIndex)
+            {
+                if (!pass_filter(listener_filters[nCurrentListenerIndex], obj))
+                {
+                    continue;
+                }
+
+                fListener = listeners[nCurrentListenerIndex];
+                catch(fListener(obj));
+                nBudget--;
+            }
         }
-    }
-/*
-    // Removed foreach because there is a gamedriver bug with function refcounts
-    foreach (object obj: local_waiting_objects)
-    {
-        foreach (function listener_func : listeners)
+
+        // Put back what we did not get to.
+        if (nCurrentObjIndex < nNumObjects)
         {
-            // We use catch te prevent runtimes from stopping the process.
-            catch(listener_func(obj));
+            waiting_chunks[--chunk_head] = chunk[nCurrentObjIndex..];
         }
-    }  
-*/  
+    }
+
+    // A listener may have armed the alarm already by cloning something.
+    if ((chunk_head < chunk_tail) && !process_alarm)
+    {
+        process_alarm = set_alarm(0.0, 0.0, process_objects);
+    }
 }
 
 /*
  * Function Name: register_new_object
  * Description:   This function gets called by every object as it is being
- *                cloned. It adds the object to a list of waiting objects,
- *                which get processed every minute.
+ *                cloned. It adds the object to the last chunk of waiting
+ *                objects, which get processed from an alarm.
  * Macro call   : LISTENER_NOTIFY(obj) in <files.h>
  */
 public void
 register_new_object(object obj)
 {
-    waiting_objects += ({ obj });
-
-    // If the size of objects is greater than 1000, we go ahead and
-    // process it immediately.
-    if (sizeof(waiting_objects) >= 1000)
+    // Without listeners there is nobody to tell.
+    if (!sizeof(listeners))
     {
-        remove_alarm(process_alarm);
-        process_alarm = 0;
-        process_objects();
         return;
     }
-    
+
+    if ((chunk_head == chunk_tail) ||
+        (sizeof(waiting_chunks[chunk_tail - 1]) >= CHUNK_SIZE))
+    {
+        waiting_chunks[chunk_tail++] = ({ });
+    }
+    waiting_chunks[chunk_tail - 1] += ({ obj });
+
     if (!process_alarm)
     {
-        process_alarm = set_alarm(1.0, 0.0, process_objects);
+        process_alarm = set_alarm(PROCESS_DELAY, 0.0, process_objects);
+    }
+}
+
+/*
+ * Function Name: query_waiting
+ * Description  : Find out how many new objects are waiting to be passed
+ *                to the listeners.
+ * Returns      : int - the number of waiting objects.
+ */
+public int
+query_waiting()
+{
+    int count;
+
+    foreach(int index, object *chunk: waiting_chunks)
+    {
+        count += sizeof(chunk);
     }
+    return count;
 }
@@ -6,6 +6,13 @@ int start_listen(string channel, string func)
     Start listening to "channel", messages will be sent to "func" in
     calling object. Returns 1 if successful, 0 if failed
 
+int start_listen_batched(string channel, string func)
+    Like start_listen, but the messages are delivered in batches. They
+    are queued, and every BATCH_DELAY seconds "func" gets one call with
+    an array of all messages that were sent in the meantime, in the
+    order they were sent. Other listeners on the channel still get one
+    call per message. Returns 1 if successful, 0 if failed.
+
 int send_signal(string channel, mixed message)
     send "message" to "channel". Returns 1 if successful, 0 if failed
 
@@ -34,6 +41,19 @@ object *query_listeners(string channel)
 
 string *query_channels(object ob)
      Returns the channels that that object is listenning to.
+
+int query_batched(string channel, object ob)
+     Returns whether ob gets the signals on the channel in batches.
+
+mapping query_channel_stats(string channel)
+     Returns the statistics of a channel:
+       "messages"      - the number of messages sent.
+       "rate"          - the average number of messages per second.
+       "listeners"     - the number of listeners.
+       "deliveries"    - the number of times the listeners were called.
+       "delivery_time" - the average time in seconds to call all
+                         listeners once.
+       "pending"       - the number of messages waiting to be delivered.
      
 Data Structures
 ---------------
@@ -52,6 +72,15 @@ listeners[ob] = channels_list
 
 secured[channel] = ({object, func})
   see secure_channel above.
+
+batch_listeners[channel][ob] = 1
+  the listeners of a channel that get their messages in batches.
+
+batched[channel] = ({ messages })
+  the messages waiting for delivery to the batch listeners of a channel.
+
+stats[channel] = ({ int since, int messages, int deliveries, float time })
+  the statistics of the channel, see query_channel_stats above.
 */
 #define USE_CALL_OUT     
 #pragma save_binary
@@ -59,11 +88,24 @@ secured[channel] = ({object, func})
 #pragma no_clone
 #pragma no_inherit
 
+#define BATCH_DELAY (0.3)
+
+#define STAT_SINCE      0
+#define STAT_MESSAGES   1
+#define STAT_DELIVERIES 2
+#define STAT_TIME       3
+
 mapping channels = ([]);
 mapping listeners = ([]);
 mapping secured = ([]);
+mapping batch_listeners = ([]);
+static mapping batched = ([]);
+static mapping stats = ([]);
+static int batch_alarm;
 
 static void restore_channels();
+static void deliver_batches();
+int query_batched(string channel, object ob);
 
 void
 create()
@@ -83,6 +125,24 @@ restore_channels()
 
 }
 
+/*
+ * Stop the batched delivery of a channel to an object. When the last
+ * batch listener is gone, the queue of the channel goes too.
+ */
+static void
+_stop_batch(string channel, object ob)
+{
+    if (!batch_listeners[channel])
+	return;
+
+    m_delkey(batch_listeners[channel], ob);
+    if (!m_sizeof(batch_listeners[channel]))
+    {
+	m_delkey(batch_listeners, channel);
+	m_delkey(batched, channel);
+    }
+}
+
 static void
 _stop_listen(string channel, object ob)
 {
@@ -91,6 +151,7 @@ _stop_listen(string channel, object ob)
     
     if(channels[channel])
 	m_delkey(channels[channel], ob);
+    _stop_batch(channel, ob);
     if (listeners[ob])
 	listeners[ob] -= ({channel});
 }
@@ -101,11 +162,9 @@ stop_listen(string channel)
     _stop_listen(channel, previous_object());
 }
 
-int
-start_listen(string channel, string func)
+static int
+_start_listen(string channel, string func, object ob)
 {
-    object ob = previous_object();
-    
     if(!channel || !stringp(channel) ||
        !func || !stringp(func))
 	return 0;
@@ -132,6 +191,28 @@ start_listen(string channel, string func)
     return 1;
 }
 
+int
+start_listen(string channel, string func)
+{
+    return _start_listen(channel, func, previous_object());
+}
+
+int
+start_listen_batched(string channel, string func)
+{
+    object ob = previous_object();
+
+    if (!_start_listen(channel, func, ob))
+	return 0;
+
+    if (!batch_listeners[channel])
+	batch_listeners[channel] = ([]);
+    batch_listeners[channel][ob] = 1;
+    if (!batched[channel])
+	batched[channel] = ({});
+    return 1;
+}
+
 static void
 _stop_listen_all(object ob)
 {
@@ -142,8 +223,11 @@ _stop_listen_all(object ob)
     {
 	n = sizeof(listeners[ob]);
 	for(i = 0; i < n; ++i)
+	{
 	    if(channels[listeners[ob][i]])
 		m_delkey(channels[listeners[ob][i]], ob);
+	    _stop_batch(listeners[ob][i], ob);
+	}
 	m_delkey(listeners, ob);
     }
     n = sizeof(chans = m_indexes(secured));
@@ -158,34 +242,59 @@ stop_listen_all()
     _stop_listen_all(previous_object());
 }
 
-int
-send_signal(string channel, mixed message)
+/*
+ * Check whether an object may send on a channel.
+ */
+static int
+may_send(string channel, object ob)
 {
-    int i, n;
-    object *obs;
-  
-    if(!channel || !stringp(channel) || !message)
-	return 0;
-    
-    if(!channels[channel])
-    {
-	channels += ([channel:([])]);
-	return 1;
-    }
-
     if (secured[channel])
 	if (!secured[channel][0])
 	    m_delkey(secured, channel);
 	else if (secured[channel][1] &&
 		 !call_other(secured[channel][0], secured[channel][1],
-			     previous_object(), channel, 1))
+			     ob, channel, 1))
 	    return 0;
-  
+    return 1;
+}
+
+/*
+ * Add a delivery of the listeners of a channel to the statistics.
+ */
+static void
+add_delivery(string channel, float start)
+{
+    if (!stats[channel])
+	stats[channel] = ({ time(), 0, 0, 0.0 });
+    stats[channel][STAT_DELIVERIES] += 1;
+    stats[channel][STAT_TIME] += gettimeofday() - start;
+}
+
+/*
+ * Call the listeners of a channel with the message, or the batch
+ * listeners with the array of queued messages. Batches are already
+ * delivered from an alarm, so the listeners are called directly.
+ */
+static void
+deliver(string channel, mixed message, int batch)
+{
+    int i, n;
+    object *obs;
+    float start = gettimeofday();
+
     n = m_sizeof(channels[channel]);
     obs = m_indexes(channels[channel]);
     for(i = 0; i < n; ++i) // send the message to all the listeners 
 	if (obs[i])
 	{
+	    /* Every listener gets either single messages or batches. */
+	    if (batch != query_batched(channel, obs[i]))
+		continue;
+	    if (batch)
+	    {
+		catch(call_other(obs[i], channels[channel][obs[i]], message));
+		continue;
+	    }
 #ifdef USE_CALL_OUT
 	    set_alarm(0.3, 0.0, &call_other(obs[i], channels[channel][obs[i]], message));
 #else
@@ -194,9 +303,93 @@ send_signal(string channel, mixed message)
 	}
 	else // the object has been destructed (this should never happen)
 	    _stop_listen_all(obs[i]);
+
+    add_delivery(channel, start);
+}
+
+int
+send_signal(string channel, mixed message)
+{
+    if(!channel || !stringp(channel) || !message)
+	return 0;
+    
+    if(!channels[channel])
+    {
+	channels += ([channel:([])]);
+	return 1;
+    }
+
+    if (!may_send(channel, previous_object()))
+	return 0;
+
+    if (!stats[channel])
+	stats[channel] = ({ time(), 0, 0, 0.0 });
+    stats[channel][STAT_MESSAGES] += 1;
+
+    /* For the batch listeners the message waits for the next delivery. */
+    if (batched[channel])
+    {
+	batched[channel] += ({ message });
+	if (!batch_alarm)
+	    batch_alarm = set_alarm(BATCH_DELAY, 0.0, deliver_batches);
+    }
+
+    deliver(channel, message, 0);
     return 1;
 }
 
+/*
+ * Called from the alarm to deliver the queued messages of all batched
+ * channels. Every listener is called once per channel.
+ */
+static void
+deliver_batches()
+{
+    int i, n;
+    string *chans;
+    mixed messages;
+
+    batch_alarm = 0;
+
+    n = sizeof(chans = m_indexes(batched));
+    for (i = 0; i < n; ++i)
+    {
+	if (!sizeof(messages = batched[chans[i]]))
+	    continue;
+	batched[chans[i]] = ({});
+	if (channels[chans[i]])
+	    deliver(chans[i], messages, 1);
+    }
+}
+
+int
+query_batched(string channel, object ob)
+{
+    return (batch_listeners[channel] && batch_listeners[channel][ob]);
+}
+
+mapping
+query_channel_stats(string channel)
+{
+    mixed stat;
+    int age;
+
+    if(!channel || !stringp(channel) || !channels[channel])
+	return 0;
+
+    if (!(stat = stats[channel]))
+	stat = ({ time(), 0, 0, 0.0 });
+    age = max(1, time() - stat[STAT_SINCE]);
+
+    return ([ "messages"      : stat[STAT_MESSAGES],
+	      "rate"          : itof(stat[STAT_MESSAGES]) / itof(age),
+	      "listeners"     : m_sizeof(channels[channel]),
+	      "deliveries"    : stat[STAT_DELIVERIES],
+	      "delivery_time" : (stat[STAT_DELIVERIES] ?
+		  (stat[STAT_TIME] / itof(stat[STAT_DELIVERIES])) : 0.0),
+	      "pending"       : sizeof(batched[channel]) ]);
+}
+
 object *
 query_listeners(string channel)
 {
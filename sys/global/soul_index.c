@@ -0,0 +1,147 @@
+/*
+ * /sys/global/soul_index.c
+ *
+ * This object keeps the index of verbs to the command souls that define
+ * them. Most livings use the very same list of souls, so the index is built
+ * once for each list of souls and shared by all livings that use it.
+ *
+ * The souls raise the generation of the index whenever their commands may
+ * have changed: when a soul is loaded, which includes a soul that is
+ * recompiled, and when it updates its commands. Then all indices are
+ * forgotten, and a living that finds that the generation has changed since
+ * it got its index asks for a fresh one.
+ *
+ * The interface:
+ *
+ *     int     query_generation()              - the current generation.
+ *     void    bump_generation()               - forget all indices.
+ *     mapping query_index(string *souls, int wiz) - the index for a list.
+ */
+
+#pragma no_clone
+#pragma no_inherit
+#pragma save_binary
+#pragma strict_types
+
+#include <std.h>
+
+/*
+ * Global variables. They are private since no one should mess with them.
+ *
+ * indices    - ([ string key : ([ string verb : ({ ({ string soul,
+ *                                                     int wizsoul }) }) ])
+ *              The kept indices by the list of souls.
+ * generation - raised whenever the commands of a soul may have changed.
+ */
+private static mapping indices = ([ ]);
+private static int     generation = 1;
+private static int     indices_built;
+
+/*
+ * Function name: create
+ * Description  : Constructor.
+ */
+public void
+create()
+{
+    setuid();
+    seteuid(getuid());
+}
+
+/*
+ * Function name: query_generation
+ * Description  : Find out the current generation of the indices.
+ * Returns      : int - the generation.
+ */
+public int
+query_generation()
+{
+    return generation;
+}
+
+/*
+ * Function name: bump_generation
+ * Description  : Called from a soul when its commands may have changed.
+ *                All indices are forgotten.
+ */
+public void
+bump_generation()
+{
+    generation++;
+    if (m_sizeof(indices))
+    {
+        indices = ([ ]);
+    }
+}
+
+/*
+ * Function name: query_index
+ * Description  : Find the index of verbs for a list of souls, building it
+ *                when needed. The index must not be altered, since it is
+ *                shared. A soul that cannot be loaded is left out, and the
+ *                index is not kept, so it is tried again next time.
+ * Arguments    : string *souls - the souls in the order they are tried.
+ *                int wiz - the number of wizard and tool souls at the start
+ *                          of the list.
+ * Returns      : mapping - ([ string verb : ({ ({ string soul,
+ *                                                 int wizsoul }) }) ])
+ */
+public mapping
+query_index(string *souls, int wiz)
+{
+    string  key = implode(souls, ",") + ":" + wiz;
+    mapping index;
+    object  ob;
+    mixed   entry;
+    int     complete = 1;
+    int     number = -1;
+    int     size = sizeof(souls);
+
+    if (mappingp(index = indices[key]))
+    {
+        return index;
+    }
+
+    index = ([ ]);
+    while(++number < size)
+    {
+        if (!(ob = find_object(souls[number])))
+        {
+            catch(souls[number]->teleledningsanka());
+            if (!(ob = find_object(souls[number])))
+            {
+                complete = 0;
+                continue;
+            }
+        }
+
+        entry = ({ souls[number], (number < wiz) });
+        foreach(string verb: m_indexes(ob->query_cmdlist()))
+        {
+            if (pointerp(index[verb]))
+                index[verb] += ({ entry });
+            else
+                index[verb] = ({ entry });
+        }
+    }
+
+    indices_built++;
+    if (complete)
+    {
+        indices[key] = index;
+    }
+    return index;
+}
+
+/*
+ * Function name: query_stats
+ * Description  : Some statistics on the operation of the index.
+ * Returns      : mapping - the statistics.
+ */
+public mapping
+query_stats()
+{
+    return ([ "indices"    : m_sizeof(indices),
+              "built"      : indices_built,
+              "generation" : generation ]);
+}
@@ -0,0 +1,448 @@
+/*
+ * /sys/global/timer_wheel.c
+ *
+ * This is a shared timer for the long running timers of items: burning
+ * torches, decaying corpses and leftovers, expiring items and lasting
+ * poisons. Instead of every item keeping its own alarm in the driver, the
+ * items register a timer here and only one alarm is ever pending in this
+ * object, armed for the earliest bucket.
+ *
+ * The timers are kept in a hierarchical wheel. The first level has buckets
+ * of one second for the timers due within a minute or so. Each next level
+ * has buckets that are WHEEL_SPOKES times as wide, for the timers that are
+ * due later. When the time of a coarse bucket has come, its timers are
+ * cascaded into the finer levels, and only timers in the first level are
+ * ever fired. This keeps the number of buckets small on every level, no
+ * matter how many timers are pending or how far ahead they are.
+ *
+ * The resolution of the timers is one second. A timer never fires early,
+ * but it may fire up to a second late.
+ *
+ * The timers of objects that were destructed are not cleaned out when the
+ * object dies, but skipped when their bucket comes up.
+ *
+ * The interface:
+ *
+ *     int   add_timer(float delay, function f) - start a timer for the
+ *                                                caller, returns the id.
+ *     void  remove_timer(int id)               - stop a timer of the caller.
+ *     float query_timer_left(int id)           - the time until it fires.
+ */
+
+#pragma no_clone
+#pragma no_inherit
+#pragma save_binary
+#pragma strict_types
+
+#include <std.h>
+
+/*
+ * WHEEL_LEVELS       - the number of levels in the wheel.
+ * WHEEL_SPOKES       - the number of buckets on a level before a timer is
+ *                      placed on the next level.
+ * WHEEL_WIDTHS       - the width of a bucket in seconds for each level.
+ * WHEEL_MAX_PER_TICK - the maximum number of timers fired from one alarm.
+ *                      The rest is continued in a fresh execution so that a
+ *                      lot of timers in one bucket do not run into the
+ *                      evaluation limit.
+ */
+#define WHEEL_LEVELS       (4)
+#define WHEEL_SPOKES       (64)
+#define WHEEL_WIDTHS       ({ 1.0, 64.0, 4096.0, 262144.0 })
+#define WHEEL_MAX_PER_TICK (50)
+
+#define REC_OWNER 0
+#define REC_FUNC  1
+#define REC_DUE   2
+#define REC_LEVEL 3
+#define REC_SLOT  4
+
+/*
+ * Global variables. They are private since no one should mess with them.
+ *
+ * timers - ([ int id : ({ object owner, function f, float due,
+ *                         int level, int slot }) ])
+ * wheel  - ({ ([ int slot : ([ int id : 1 ]) ]) }) with a mapping for
+ *          each level.
+ */
+private static mapping timers = ([ ]);
+private static mapping *wheel = allocate(WHEEL_LEVELS);
+private static float  *widths = WHEEL_WIDTHS;
+private static float   epoch;
+private static float   tick_time;
+private static int     tick_alarm;
+private static int     ticking;
+private static int     last_id;
+private static int     ticks_run;
+private static int     timers_fired;
+private static int     timers_cascaded;
+
+/*
+ * Prototypes.
+ */
+static void tick();
+
+/*
+ * Function name: create
+ * Description  : Constructor. Marks the epoch relative to which all times
+ *                in the wheel are computed. This keeps the slot numbers
+ *                small.
+ */
+public void
+create()
+{
+    int level;
+
+    setuid();
+    seteuid(getuid());
+
+    epoch = gettimeofday();
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        wheel[level] = ([ ]);
+    }
+}
+
+/*
+ * Function name: clock_now
+ * Description  : Find out the current time relative to the epoch.
+ * Returns      : float - the time in seconds.
+ */
+static float
+clock_now()
+{
+    return gettimeofday() - epoch;
+}
+
+/*
+ * Function name: slot_time
+ * Description  : Find the time at which a bucket must be handled. A bucket
+ *                on the first level is fired at its end, so that no timer
+ *                fires before it is due. A bucket on a higher level is
+ *                cascaded at its start.
+ * Arguments    : int level - the level of the bucket.
+ *                int slot - the slot of the bucket.
+ * Returns      : float - the time relative to the epoch.
+ */
+static float
+slot_time(int level, int slot)
+{
+    if (!level)
+    {
+        return itof(slot + 1) * widths[0];
+    }
+
+    return itof(slot) * widths[level];
+}
+
+/*
+ * Function name: arm_alarm
+ * Description  : Make sure the alarm is set for the given time, if it is
+ *                earlier than the time the alarm is currently set for.
+ *                While the wheel is ticking, the alarm is set afterwards.
+ * Arguments    : float when - the time the wheel must be ticked.
+ */
+static void
+arm_alarm(float when)
+{
+    if (ticking ||
+        (tick_alarm && (tick_time <= when)))
+    {
+        return;
+    }
+
+    remove_alarm(tick_alarm);
+    tick_time = when;
+    tick_alarm = set_alarm(max(0.0, when - clock_now()), 0.0, tick);
+}
+
+/*
+ * Function name: arm_earliest
+ * Description  : Set the alarm for the earliest bucket in the wheel.
+ */
+static void
+arm_earliest()
+{
+    float when, first;
+    int level, found;
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        if (!m_sizeof(wheel[level]))
+        {
+            continue;
+        }
+
+        when = slot_time(level, sort_array(m_indexes(wheel[level]))[0]);
+        if (!found || (when < first))
+        {
+            first = when;
+            found = 1;
+        }
+    }
+
+    if (found)
+    {
+        arm_alarm(first);
+    }
+}
+
+/*
+ * Function name: insert_timer
+ * Description  : Place a timer in the bucket it belongs to, given the time
+ *                that is left until it is due.
+ * Arguments    : int id - the id of the timer.
+ *                float now - the current time.
+ */
+static void
+insert_timer(int id, float now)
+{
+    mixed rec = timers[id];
+    float left = rec[REC_DUE] - now;
+    int level, slot;
+
+    while ((level < (WHEEL_LEVELS - 1)) &&
+        (left >= (widths[level] * itof(WHEEL_SPOKES))))
+    {
+        level++;
+    }
+
+    slot = ftoi(rec[REC_DUE] / widths[level]);
+    rec[REC_LEVEL] = level;
+    rec[REC_SLOT] = slot;
+
+    if (!mappingp(wheel[level][slot]))
+    {
+        wheel[level][slot] = ([ ]);
+    }
+    wheel[level][slot][id] = 1;
+
+    arm_alarm(slot_time(level, slot));
+}
+
+/*
+ * Function name: unlink_timer
+ * Description  : Remove a timer from its bucket and from the wheel.
+ * Arguments    : int id - the id of the timer.
+ */
+static void
+unlink_timer(int id)
+{
+    mixed rec;
+    mapping bucket;
+
+    if (!pointerp(rec = timers[id]))
+    {
+        return;
+    }
+
+    bucket = wheel[rec[REC_LEVEL]][rec[REC_SLOT]];
+    if (mappingp(bucket))
+    {
+        m_delkey(bucket, id);
+        if (!m_sizeof(bucket))
+        {
+            m_delkey(wheel[rec[REC_LEVEL]], rec[REC_SLOT]);
+        }
+    }
+    m_delkey(timers, id);
+}
+
+/*
+ * Function name: add_timer
+ * Description  : Called from an object to start a timer. The function is
+ *                called once when the timer is due, unless the object was
+ *                destructed by then.
+ * Arguments    : float delay - the number of seconds until the timer is due.
+ *                function f - the function to call.
+ * Returns      : int - the id of the timer, or 0 in case of failure.
+ */
+public int
+add_timer(float delay, function f)
+{
+    float now;
+
+    if (!functionp(f))
+    {
+        return 0;
+    }
+
+    now = clock_now();
+    timers[++last_id] = ({ previous_object(), f, now + max(0.0, delay),
+        0, 0 });
+    insert_timer(last_id, now);
+
+    return last_id;
+}
+
+/*
+ * Function name: remove_timer
+ * Description  : Called from an object to stop one of its timers.
+ * Arguments    : int id - the id of the timer.
+ */
+public void
+remove_timer(int id)
+{
+    mixed rec;
+
+    if (!pointerp(rec = timers[id]) ||
+        (rec[REC_OWNER] != previous_object()))
+    {
+        return;
+    }
+
+    unlink_timer(id);
+}
+
+/*
+ * Function name: query_timer_left
+ * Description  : Find out how much time is left until a timer is due.
+ * Arguments    : int id - the id of the timer.
+ * Returns      : float - the time in seconds, or -1.0 if there is no such
+ *                timer.
+ */
+public float
+query_timer_left(int id)
+{
+    mixed rec;
+
+    if (!pointerp(rec = timers[id]) ||
+        !objectp(rec[REC_OWNER]))
+    {
+        return -1.0;
+    }
+
+    return max(0.0, rec[REC_DUE] - clock_now());
+}
+
+/*
+ * Function name: tick
+ * Description  : Called from the alarm. First the buckets on the higher
+ *                levels that have come up are cascaded into the finer
+ *                levels, then all timers in the buckets on the first level
+ *                that are due are fired.
+ */
+static void
+tick()
+{
+    int level, count, *slots;
+    mapping bucket;
+    function f;
+    float now;
+    mixed rec;
+
+    tick_alarm = 0;
+    ticking = 1;
+    ticks_run++;
+    /* The alarm may fire a hair early, so always run the time it was for. */
+    now = max(clock_now(), tick_time);
+
+    for (level = WHEEL_LEVELS - 1; level > 0; level--)
+    {
+        foreach(int slot: m_indexes(wheel[level]))
+        {
+            if (slot_time(level, slot) > now)
+            {
+                continue;
+            }
+
+            bucket = wheel[level][slot];
+            m_delkey(wheel[level], slot);
+            foreach(int id: m_indexes(bucket))
+            {
+                if (!pointerp(rec = timers[id]))
+                {
+                    continue;
+                }
+                if (!objectp(rec[REC_OWNER]))
+                {
+                    m_delkey(timers, id);
+                    continue;
+                }
+
+                timers_cascaded++;
+                insert_timer(id, now);
+            }
+        }
+    }
+
+    slots = sort_array(m_indexes(wheel[0]));
+    foreach(int slot: slots)
+    {
+        if (slot_time(0, slot) > now)
+        {
+            break;
+        }
+
+        bucket = wheel[0][slot];
+        foreach(int id: m_indexes(bucket))
+        {
+            /* Keep the rest for a fresh execution. */
+            if (count >= WHEEL_MAX_PER_TICK)
+            {
+                ticking = 0;
+                tick_time = now;
+                tick_alarm = set_alarm(0.0, 0.0, tick);
+                return;
+            }
+
+            m_delkey(bucket, id);
+            rec = timers[id];
+            m_delkey(timers, id);
+            if (!pointerp(rec) ||
+                !objectp(rec[REC_OWNER]))
+            {
+                continue;
+            }
+
+            count++;
+            timers_fired++;
+            f = rec[REC_FUNC];
+            catch(f());
+        }
+
+        if (mappingp(wheel[0][slot]) && !m_sizeof(wheel[0][slot]))
+        {
+            m_delkey(wheel[0], slot);
+        }
+    }
+
+    /* Make sure we are armed for the earliest remaining bucket. */
+    ticking = 0;
+    arm_earliest();
+}
+
+/*
+ * Function name: query_stats
+ * Description  : Some statistics on the operation of the wheel.
+ * Returns      : mapping - the statistics.
+ */
+public mapping
+query_stats()
+{
+    return ([ "timers"   : m_sizeof(timers),
+              "buckets"  : map(wheel, m_sizeof),
+              "ticks"    : ticks_run,
+              "fired"    : timers_fired,
+              "cascaded" : timers_cascaded ]);
+}
+
+/*
+ * Function name: remove_object
+ * Description  : Only allow destruction when no timers of living objects
+ *                are pending, since they would never fire.
+ */
+public int
+remove_object()
+{
+    foreach(int id, mixed rec: timers)
+    {
+        if (objectp(rec[REC_OWNER]))
+        {
+            return 0;
+        }
+    }
+
+    destruct();
+    return 1;
+}
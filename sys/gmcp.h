@@ -115,9 +115,6 @@
 /* Default options. */
 #define GMCP_DEFAULT_OPTIONS ([ GMCP_NPC_COMMS : 1 ])
 
-/* Interval for the alarm to run on players using GMCP. */
-#define GMCP_INTERVAL  60.0
-
 /* The token to identify a player with, based on his name and last login time. */
 #define GMCP_PLAYER_TOKEN(name, login_time) (crypt((name), "$1$" + (login_time) + "$")[-8..])
 
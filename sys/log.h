@@ -236,6 +236,15 @@
  */
 #define LOG_GMCP "GMCP"
 
+/*
+ * LOG_BUFFERED - The system logs that are written to very often. Text for
+ * these logs is collected in memory and written in batches. Undefine it to
+ * write every line at once.
+ *
+ * Used in: /secure/master.c
+ */
+#define LOG_BUFFERED ({ "COMBAT_LOG", "CRITICAL" })
+
 /*
  * AOP_TEAM_LOGS
  *
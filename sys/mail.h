@@ -163,6 +163,7 @@
 #define MAIL_FLAGS ({ "no mail", "already read mail", "NEW mail", "unread messages" })
 
 #define MAX_CYCLE     15         /* Maximum number of mail sent in one loop */
+#define MAX_SPOOL     50         /* Maximum number of mail spooled per loop */
 #define READER_ID     "_reader_" /* Id for use with present()               */
 #define MAX_NO_MREAD  "++"       /* You cannot read >100 lines without more */
 #define MAX_SUBJECT   50         /* Maxmimum subject length                 */
@@ -175,6 +176,8 @@
 #define READER_HELP   "/doc/help/general/mail_"
 #define FILE_NAME_MAIL(n) \
     (MAIL_DIR + extract((n), 0, 0) + "/" + (n))
+#define FILE_NAME_JOURNAL(n) \
+    (MAIL_DIR + extract((n), 0, 0) + "/" + (n) + ".journal")
 #define FILE_NAME_MESSAGE(t, h) \
     (MSG_DIR + "d" + ((t) % (h)) + "/m" + (t))
 
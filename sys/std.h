@@ -34,6 +34,20 @@
 #define SANCTION_DIR    "/data/sanctions/"
 #define SAVED_PLAYERS_DIR "/data/saved/"
 #define SECONDS_SAVE    "/data/seconds"
+#define PLAYER_INDEX_SAVE "/data/player_index"
+
+/*
+ * The indices to an entry in the player index that is returned by
+ * SECURITY->query_player_index(name).
+ */
+#define PIDX_FILE_TIME  0
+#define PIDX_FILE_SIZE  1
+#define PIDX_LOGIN      2
+#define PIDX_LOGOUT     3
+#define PIDX_AGE        4
+#define PIDX_RANK       5
+#define PIDX_RESTRICT   6
+#define PIDX_AVERAGE    7
 
 /*
  * CALLED_BY_SECURITY